@@ -1,47 +1,1029 @@
 #pragma once
 #include <algorithm>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
 #include <exception>
+#include <fstream>
 #include <functional>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <optional>
 #include <unordered_map>
 #include <queue>
+#include <ranges>
 #include <stack>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/** Indexed d-ary min-heap of dense vertex indices, ordered by their priorities.
+* Each vertex is held at most once and its position is tracked, so that decreasing its priority
+* costs O(log n). The storage for all the vertices is allocated once, on construction.
+* @param priority_t - type of the priorities
+* @param arity - the number of the children of each node
+*/
+template <class priority_t, unsigned arity = 4>
+class d_ary_heap_t
+{
+	static_assert(arity >= 2, "the arity of a heap must be at least 2");
+	static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+	std::vector<std::pair<priority_t, uint32_t>> nodes;
+	std::vector<uint32_t> place;
+	void sift_up(size_t position);
+	void sift_down(size_t position);
+public:
+	explicit d_ary_heap_t(size_t capacity) : place(capacity, absent) { nodes.reserve(capacity); }
+	bool empty() const { return nodes.empty(); }
+	bool contains(uint32_t vertex) const { return place[vertex] != absent; }
+	uint32_t top() const { return nodes.front().second; }
+	void push(uint32_t vertex, priority_t priority);
+	void decrease(uint32_t vertex, priority_t priority);
+	uint32_t pop();
+};
+
+template <class priority_t, unsigned arity>
+void d_ary_heap_t<priority_t, arity>::sift_up(size_t position)
+{
+	std::pair<priority_t, uint32_t> node = nodes[position];
+	while (position > 0)
+	{
+		size_t parent = (position - 1) / arity;
+		if (not (node.first < nodes[parent].first))
+			break;
+		nodes[position] = nodes[parent];
+		place[nodes[position].second] = static_cast<uint32_t>(position);
+		position = parent;
+	}
+	nodes[position] = node;
+	place[node.second] = static_cast<uint32_t>(position);
+}
+
+template <class priority_t, unsigned arity>
+void d_ary_heap_t<priority_t, arity>::sift_down(size_t position)
+{
+	std::pair<priority_t, uint32_t> node = nodes[position];
+	for (;;)
+	{
+		size_t first = position * arity + 1;
+		if (first >= nodes.size())
+			break;
+		size_t last = std::min(first + arity, nodes.size()), least = first;
+		for (size_t child = first + 1; child < last; ++child)
+		{
+			if (nodes[child].first < nodes[least].first)
+				least = child;
+		}
+		if (not (nodes[least].first < node.first))
+			break;
+		nodes[position] = nodes[least];
+		place[nodes[position].second] = static_cast<uint32_t>(position);
+		position = least;
+	}
+	nodes[position] = node;
+	place[node.second] = static_cast<uint32_t>(position);
+}
+
+/// Inserts 'vertex', which must be absent in the heap.
+template <class priority_t, unsigned arity>
+void d_ary_heap_t<priority_t, arity>::push(uint32_t vertex, priority_t priority)
+{
+	nodes.emplace_back(priority, vertex);
+	sift_up(nodes.size() - 1);
+}
+
+/// Lowers the priority of 'vertex', which must be present in the heap.
+template <class priority_t, unsigned arity>
+void d_ary_heap_t<priority_t, arity>::decrease(uint32_t vertex, priority_t priority)
+{
+	nodes[place[vertex]].first = priority;
+	sift_up(place[vertex]);
+}
+
+/// Removes the vertex of the least priority from the heap and returns it.
+template <class priority_t, unsigned arity>
+uint32_t d_ary_heap_t<priority_t, arity>::pop()
+{
+	uint32_t vertex = nodes.front().second;
+	place[vertex] = absent;
+	if (nodes.size() > 1)
+	{
+		nodes.front() = nodes.back();
+		nodes.pop_back();
+		sift_down(0);
+	}
+	else
+		nodes.pop_back();
+	return vertex;
+}
+
+/** Pairing min-heap of dense vertex indices, ordered by their priorities.
+* The nodes are preallocated for all the vertices and linked by indices; decreasing the priority
+* of a vertex costs O(1) and removing the least one costs O(log n) amortised.
+* @param priority_t - type of the priorities
+*/
+template <class priority_t>
+class pairing_heap_t
+{
+	static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+	struct node_t
+	{
+		priority_t priority;
+		uint32_t child, sibling, previous;
+		bool present;
+	};
+	std::vector<node_t> nodes;
+	std::vector<uint32_t> roots;
+	uint32_t root;
+	uint32_t meld(uint32_t first, uint32_t second);
+	void detach(uint32_t vertex);
+public:
+	explicit pairing_heap_t(size_t capacity)
+		: nodes(capacity, node_t{ priority_t(), absent, absent, absent, false }), root(absent) {}
+	bool empty() const { return root == absent; }
+	bool contains(uint32_t vertex) const { return nodes[vertex].present; }
+	uint32_t top() const { return root; }
+	void push(uint32_t vertex, priority_t priority);
+	void decrease(uint32_t vertex, priority_t priority);
+	uint32_t pop();
+};
+
+/// Links two trees and returns the root of the resulting one.
+template <class priority_t>
+uint32_t pairing_heap_t<priority_t>::meld(uint32_t first, uint32_t second)
+{
+	if (first == absent)
+		return second;
+	if (second == absent)
+		return first;
+	if (nodes[second].priority < nodes[first].priority)
+		std::swap(first, second);
+	nodes[second].previous = first;
+	nodes[second].sibling = nodes[first].child;
+	if (nodes[first].child != absent)
+		nodes[nodes[first].child].previous = second;
+	nodes[first].child = second;
+	nodes[first].sibling = absent;
+	nodes[first].previous = absent;
+	return first;
+}
+
+/// Cuts the subtree of 'vertex' off its parent.
+template <class priority_t>
+void pairing_heap_t<priority_t>::detach(uint32_t vertex)
+{
+	node_t& node = nodes[vertex];
+	if (nodes[node.previous].child == vertex)
+		nodes[node.previous].child = node.sibling;
+	else
+		nodes[node.previous].sibling = node.sibling;
+	if (node.sibling != absent)
+		nodes[node.sibling].previous = node.previous;
+	node.sibling = absent;
+	node.previous = absent;
+}
+
+/// Inserts 'vertex', which must be absent in the heap.
+template <class priority_t>
+void pairing_heap_t<priority_t>::push(uint32_t vertex, priority_t priority)
+{
+	nodes[vertex] = node_t{ priority, absent, absent, absent, true };
+	root = meld(root, vertex);
+}
+
+/// Lowers the priority of 'vertex', which must be present in the heap.
+template <class priority_t>
+void pairing_heap_t<priority_t>::decrease(uint32_t vertex, priority_t priority)
+{
+	nodes[vertex].priority = priority;
+	if (vertex == root)
+		return;
+	detach(vertex);
+	root = meld(root, vertex);
+}
+
+/// Removes the vertex of the least priority from the heap and returns it.
+template <class priority_t>
+uint32_t pairing_heap_t<priority_t>::pop()
+{
+	uint32_t vertex = root;
+	nodes[vertex].present = false;
+	roots.clear();
+	for (uint32_t child = nodes[vertex].child; child != absent; )
+	{
+		uint32_t next = nodes[child].sibling;
+		nodes[child].sibling = absent;
+		nodes[child].previous = absent;
+		roots.push_back(child);
+		child = next;
+	}
+	nodes[vertex].child = absent;
+	size_t count = 0;
+	for (size_t i = 0; i + 1 < roots.size(); i += 2)
+		roots[count++] = meld(roots[i], roots[i + 1]);
+	if (roots.size() % 2 == 1)
+		roots[count++] = roots.back();
+	root = absent;
+	while (count > 0)
+		root = meld(roots[--count], root);
+	return vertex;
+}
+
+/** Indexed monotone bucket queue of dense vertex indices for integral priorities (the Dial's algorithm).
+* The vertices of priority 'p' are kept in bucket 'p' modulo the width of a ring wider than the difference between
+* any two of the priorities, and grows to remain so; no priority may be less than that of the vertex removed
+* last. Each operation costs O(1), plus the scan over the empty buckets, which in a search for the shortest
+* paths costs at most the greatest distance in total. It suits the weights that are small integers.
+* @param priority_t - integral type of the priorities
+*/
+template <class priority_t>
+class Dial_heap_t
+{
+	static_assert(std::is_integral_v<priority_t>, "the priorities of a bucket queue must be integral");
+	static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+	std::vector<std::vector<uint32_t>> buckets;
+	std::vector<priority_t> priority;
+	std::vector<uint32_t> place;
+	// No vertex in the queue has less priority than 'least'.
+	priority_t least;
+	size_t count;
+	size_t bucket(priority_t value) const { return static_cast<size_t>(value) & (buckets.size() - 1); }
+	void insert(uint32_t vertex);
+	void remove(uint32_t vertex);
+	void widen(size_t span);
+	void admit(priority_t value);
+public:
+	explicit Dial_heap_t(size_t capacity) : buckets(1), priority(capacity), place(capacity, absent), least(), count(0) {}
+	bool empty() const { return count == 0; }
+	bool contains(uint32_t vertex) const { return place[vertex] != absent; }
+	uint32_t top() const;
+	void push(uint32_t vertex, priority_t value);
+	void decrease(uint32_t vertex, priority_t value);
+	uint32_t pop();
+};
+
+template <class priority_t>
+void Dial_heap_t<priority_t>::insert(uint32_t vertex)
+{
+	std::vector<uint32_t>& items = buckets[bucket(priority[vertex])];
+	place[vertex] = static_cast<uint32_t>(items.size());
+	items.push_back(vertex);
+	++count;
+}
+
+template <class priority_t>
+void Dial_heap_t<priority_t>::remove(uint32_t vertex)
+{
+	std::vector<uint32_t>& items = buckets[bucket(priority[vertex])];
+	items[place[vertex]] = items.back();
+	place[items[place[vertex]]] = place[vertex];
+	items.pop_back();
+	place[vertex] = absent;
+	--count;
+}
+
+/// Doubles the ring until it is wider than 'span' and redistributes the vertices.
+template <class priority_t>
+void Dial_heap_t<priority_t>::widen(size_t span)
+{
+	size_t width = buckets.size();
+	while (width <= span)
+		width *= 2;
+	std::vector<std::vector<uint32_t>> old(width);
+	old.swap(buckets);
+	count = 0;
+	for (auto b = old.begin(); b != old.end(); ++b)
+	{
+		for (auto v = b->begin(); v != b->end(); ++v)
+			insert(*v);
+	}
+}
+
+template <class priority_t>
+uint32_t Dial_heap_t<priority_t>::top() const
+{
+	priority_t value = least;
+	while (buckets[bucket(value)].empty())
+		++value;
+	return buckets[bucket(value)].back();
+}
+
+/// Lowers 'least' to 'value' if it is less and widens the ring to hold 'value' together with the vertices present.
+template <class priority_t>
+void Dial_heap_t<priority_t>::admit(priority_t value)
+{
+	if (count == 0)
+		least = value;
+	else if (value < least)
+	{
+		// The ring must still hold the priorities up to those of the vertices inserted before.
+		widen(static_cast<size_t>(least - value) + buckets.size() - 1);
+		least = value;
+	}
+	if (static_cast<size_t>(value - least) >= buckets.size())
+		widen(static_cast<size_t>(value - least));
+}
+
+/// Inserts 'vertex', which must be absent in the heap, with a priority not less than that of the vertex removed last.
+template <class priority_t>
+void Dial_heap_t<priority_t>::push(uint32_t vertex, priority_t value)
+{
+	admit(value);
+	priority[vertex] = value;
+	insert(vertex);
+}
+
+/// Lowers the priority of 'vertex', which must be present in the heap; the new one may be less than 'least',
+/// which push() raises past the vertex removed last when it finds the heap empty.
+template <class priority_t>
+void Dial_heap_t<priority_t>::decrease(uint32_t vertex, priority_t value)
+{
+	remove(vertex);
+	admit(value);
+	priority[vertex] = value;
+	insert(vertex);
+}
+
+/// Removes a vertex of the least priority from the heap and returns it.
+template <class priority_t>
+uint32_t Dial_heap_t<priority_t>::pop()
+{
+	while (buckets[bucket(least)].empty())
+		++least;
+	uint32_t vertex = buckets[bucket(least)].back();
+	remove(vertex);
+	return vertex;
+}
+
+/** Indexed monotone radix heap of dense vertex indices for integral priorities. A vertex lies in bucket
+* 'b' if its priority differs from that of the vertex removed last first in bit 'b - 1' (bucket 0: not at
+* all); removing the least vertex from an empty bucket 0 moves the vertices of the lowest non-empty bucket
+* to the lower ones. No priority may be less than that of the vertex removed last. Each vertex is moved at
+* most once per bit of the priorities, so a search for the shortest paths costs O(m + n log C), with C the
+* greatest weight; it suits the integral weights too large for Dial_heap_t.
+* @param priority_t - integral type of the priorities
+*/
+template <class priority_t>
+class radix_heap_t
+{
+	static_assert(std::is_integral_v<priority_t>, "the priorities of a radix heap must be integral");
+	using bits_t = std::make_unsigned_t<priority_t>;
+	static constexpr uint32_t absent = std::numeric_limits<uint32_t>::max();
+	std::vector<uint32_t> buckets[std::numeric_limits<bits_t>::digits + 1];
+	// The priorities mapped to the unsigned keys of the same order.
+	std::vector<bits_t> priority;
+	std::vector<uint32_t> place;
+	std::vector<unsigned char> home;
+	// The key of the vertex removed last, initially the least one.
+	bits_t last;
+	size_t count;
+	static bits_t key(priority_t value)
+	{
+		if constexpr (std::is_signed_v<priority_t>)
+			return static_cast<bits_t>(value) ^ (bits_t(1) << (std::numeric_limits<bits_t>::digits - 1));
+		else
+			return value;
+	}
+	unsigned bucket(bits_t value) const { return static_cast<unsigned>(std::bit_width(static_cast<bits_t>(value ^ last))); }
+	void insert(uint32_t vertex);
+	void remove(uint32_t vertex);
+	size_t lowest() const;
+public:
+	explicit radix_heap_t(size_t capacity) : priority(capacity), place(capacity, absent), home(capacity, 0), last(0), count(0) {}
+	bool empty() const { return count == 0; }
+	bool contains(uint32_t vertex) const { return place[vertex] != absent; }
+	uint32_t top() const;
+	void push(uint32_t vertex, priority_t value);
+	void decrease(uint32_t vertex, priority_t value);
+	uint32_t pop();
+};
+
+template <class priority_t>
+void radix_heap_t<priority_t>::insert(uint32_t vertex)
+{
+	home[vertex] = static_cast<unsigned char>(bucket(priority[vertex]));
+	std::vector<uint32_t>& items = buckets[home[vertex]];
+	place[vertex] = static_cast<uint32_t>(items.size());
+	items.push_back(vertex);
+	++count;
+}
+
+template <class priority_t>
+void radix_heap_t<priority_t>::remove(uint32_t vertex)
+{
+	std::vector<uint32_t>& items = buckets[home[vertex]];
+	items[place[vertex]] = items.back();
+	place[items[place[vertex]]] = place[vertex];
+	items.pop_back();
+	place[vertex] = absent;
+	--count;
+}
+
+/// Returns the lowest non-empty bucket, which must exist.
+template <class priority_t>
+size_t radix_heap_t<priority_t>::lowest() const
+{
+	size_t b = 0;
+	while (buckets[b].empty())
+		++b;
+	return b;
+}
+
+template <class priority_t>
+uint32_t radix_heap_t<priority_t>::top() const
+{
+	const std::vector<uint32_t>& items = buckets[lowest()];
+	uint32_t least = items.front();
+	// The last of the least vertices comes out of bucket 0 first, after pop() moves them there.
+	for (auto v = items.begin(); v != items.end(); ++v)
+	{
+		if (priority[*v] <= priority[least])
+			least = *v;
+	}
+	return least;
+}
+
+/// Inserts 'vertex', which must be absent in the heap, with a priority not less than that of the vertex removed last.
+template <class priority_t>
+void radix_heap_t<priority_t>::push(uint32_t vertex, priority_t value)
+{
+	priority[vertex] = key(value);
+	insert(vertex);
+}
+
+/// Lowers the priority of 'vertex', which must be present in the heap.
+template <class priority_t>
+void radix_heap_t<priority_t>::decrease(uint32_t vertex, priority_t value)
+{
+	remove(vertex);
+	priority[vertex] = key(value);
+	insert(vertex);
+}
+
+/// Removes a vertex of the least priority from the heap and returns it.
+template <class priority_t>
+uint32_t radix_heap_t<priority_t>::pop()
+{
+	if (buckets[0].empty())
+	{
+		size_t b = lowest();
+		std::vector<uint32_t> moved;
+		moved.swap(buckets[b]);
+		last = priority[moved.front()];
+		for (auto v = moved.begin(); v != moved.end(); ++v)
+			last = std::min(last, priority[*v]);
+		count -= moved.size();
+		for (auto v = moved.begin(); v != moved.end(); ++v)
+			insert(*v);
+		// Every vertex moved to a lower bucket; the storage is given back for the next time.
+		moved.clear();
+		moved.swap(buckets[b]);
+	}
+	uint32_t vertex = buckets[0].back();
+	remove(vertex);
+	last = priority[vertex];
+	return vertex;
+}
+
+/** Stands for the heap that the searches for the shortest paths choose at run time for the integral weights:
+* Dial_heap_t if no edge is heavier than 'Dial_limit', otherwise radix_heap_t.
+*/
+template <class priority_t>
+struct automatic_heap_t
+{
+	static constexpr uint64_t Dial_limit = 1 << 15;
+};
+
+/** The default heap of the searches for the shortest paths: automatic_heap_t for the integral weights, otherwise
+* d_ary_heap_t. Any of the heaps above may be chosen instead; Dial_heap_t and radix_heap_t take only integral weights.
+*/
+template <class priority_t>
+using default_heap_t = std::conditional_t<std::is_integral_v<priority_t>, automatic_heap_t<priority_t>, d_ary_heap_t<priority_t>>;
+
+/// The cost of the paths to the unreachable vertices: infinity, or the greatest value of the types without it.
+template <class cost_t>
+constexpr cost_t infinite_cost()
+{
+	if constexpr (std::numeric_limits<cost_t>::has_infinity)
+		return std::numeric_limits<cost_t>::infinity();
+	else
+		return std::numeric_limits<cost_t>::max();
+}
+
+/// Adds 'weight' to 'cost'; an infinite cost of a type without infinity remains infinite instead of overflowing.
+template <class cost_t, class weight_t>
+cost_t extend_cost(cost_t cost, weight_t weight)
+{
+	if constexpr (std::numeric_limits<cost_t>::has_infinity)
+		return cost + weight;
+	else
+		return cost == infinite_cost<cost_t>() ? cost : static_cast<cost_t>(cost + weight);
+}
+
+/// Read-only mapping of a whole file into the memory of the process; an empty file has no view.
+class file_mapping_t
+{
+	const char* view;
+	size_t length;
+#ifdef _WIN32
+	HANDLE file, mapping;
+#else
+	int file;
+#endif
+public:
+	explicit file_mapping_t(const std::string& path);
+	file_mapping_t(const file_mapping_t&) = delete;
+	file_mapping_t& operator=(const file_mapping_t&) = delete;
+	~file_mapping_t();
+	const char* begin() const { return view; }
+	size_t size() const { return length; }
+};
+
+/** Calls 'body(i)' for every 'i' in [0, count), spread over 'threads' threads including the calling one.
+* The calls are handed out in increasing order as the threads become free; the first exception thrown
+* by 'body' is rethrown once all the threads have finished.
+*/
+template <class body_t>
+void parallel_for(size_t count, size_t threads, const body_t& body)
+{
+	threads = std::min(std::max<size_t>(threads, 1), count);
+	if (threads <= 1)
+	{
+		for (size_t i = 0; i < count; ++i)
+			body(i);
+		return;
+	}
+	std::atomic<size_t> next(0);
+	std::exception_ptr failure;
+	std::atomic<bool> failed(false);
+	auto work = [&]()
+	{
+		try
+		{
+			for (size_t i = next++; i < count and not failed; i = next++)
+				body(i);
+		}
+		catch (...)
+		{
+			if (not failed.exchange(true))
+				failure = std::current_exception();
+		}
+	};
+	std::vector<std::thread> workers;
+	for (size_t t = 1; t < threads; ++t)
+		workers.emplace_back(work);
+	work();
+	for (auto w = workers.begin(); w != workers.end(); ++w)
+		w->join();
+	if (failure)
+		std::rethrow_exception(failure);
+}
+
+/** The base of the visitors of my_graph::breadth_first_search() and depth_first_search(), whose events
+* do nothing. A visitor derives from it and hides the events it handles; an event returning false stops
+* the search. A vertex is discovered when it is first reached, and finished when all its outedges have
+* been examined; a tree edge is an examined edge leading to an undiscovered vertex.
+*/
+struct search_visitor_t
+{
+	template <class key_t, class data_t>
+	bool discover_vertex(const key_t& vertex, data_t& data) { return true; }
+	template <class key_t, class weight_t>
+	bool examine_edge(const key_t& tail, const key_t& head, const weight_t& weight) { return true; }
+	template <class key_t, class weight_t>
+	bool tree_edge(const key_t& tail, const key_t& head, const weight_t& weight) { return true; }
+	template <class key_t, class data_t>
+	bool finish_vertex(const key_t& vertex, data_t& data) { return true; }
+};
+
+/// The text formats of edge lists read by my_graph::load_edges().
+enum class edge_format_t
+{
+	// "tail head [weight]" separated by whitespace; the lines beginning with '#' are comments
+	SNAP,
+	// "a tail head weight" arcs of the DIMACS shortest paths challenge; the other lines are skipped
+	DIMACS,
+	// "tail,head[,weight]"; the lines beginning with '#' are comments, an unreadable first line is a header
+	CSV
+};
+
+/** Vector that keeps up to 'inline_capacity' items inside itself and moves them to the memory of the allocator
+* only when they outgrow it, so that a short sequence takes no allocation of its own. Like std::vector, it
+* invalidates the iterators when it grows; a move assignment or a swap keeps the allocators in place.
+* @param item_t - type of the items
+* @param inline_capacity - the number of the items kept inside
+* @param allocator_t - the allocator of the items that do not fit inside
+*/
+template <class item_t, size_t inline_capacity, class allocator_t = std::allocator<item_t>>
+class small_vector_t
+{
+	static_assert(inline_capacity > 0, "a small vector must keep at least one item inside");
+	using traits_t = std::allocator_traits<allocator_t>;
+	allocator_t allocator;
+	item_t* first;
+	uint32_t count, capacity;
+	alignas(item_t) unsigned char buffer[inline_capacity * sizeof(item_t)];
+	item_t* inside() { return reinterpret_cast<item_t*>(buffer); }
+	void grow(size_t minimum);
+	void release();
+public:
+	using value_type = item_t;
+	using allocator_type = allocator_t;
+	using iterator = item_t*;
+	using const_iterator = const item_t*;
+	explicit small_vector_t(const allocator_t& _allocator = allocator_t())
+		: allocator(_allocator), first(inside()), count(0), capacity(inline_capacity) {}
+	small_vector_t(const small_vector_t& other, const allocator_t& _allocator);
+	small_vector_t(const small_vector_t& other)
+		: small_vector_t(other, traits_t::select_on_container_copy_construction(other.allocator)) {}
+	small_vector_t(small_vector_t&& other) noexcept;
+	small_vector_t& operator=(const small_vector_t& other);
+	small_vector_t& operator=(small_vector_t&& other);
+	~small_vector_t() { release(); }
+	allocator_t get_allocator() const { return allocator; }
+	iterator begin() { return first; }
+	iterator end() { return first + count; }
+	const_iterator begin() const { return first; }
+	const_iterator end() const { return first + count; }
+	const_iterator cbegin() const { return first; }
+	const_iterator cend() const { return first + count; }
+	size_t size() const { return count; }
+	bool empty() const { return count == 0; }
+	item_t& operator[](size_t position) { return first[position]; }
+	const item_t& operator[](size_t position) const { return first[position]; }
+	item_t& back() { return first[count - 1]; }
+	template <class... arguments_t> item_t& emplace_back(arguments_t&&... arguments);
+	void push_back(const item_t& item) { emplace_back(item); }
+	void pop_back();
+	void reserve(size_t minimum);
+	void clear();
+	void swap(small_vector_t& other);
+};
+
+template <class item_t, size_t inline_capacity, class allocator_t>
+small_vector_t<item_t, inline_capacity, allocator_t>::small_vector_t(const small_vector_t& other, const allocator_t& _allocator)
+	: small_vector_t(_allocator)
+{
+	reserve(other.count);
+	for (const item_t* i = other.begin(); i != other.end(); ++i)
+		traits_t::construct(allocator, first + count++, *i);
+}
+
+/// Takes over the items of 'other', which is left empty; the items kept inside are moved one by one.
+template <class item_t, size_t inline_capacity, class allocator_t>
+small_vector_t<item_t, inline_capacity, allocator_t>::small_vector_t(small_vector_t&& other) noexcept
+	: small_vector_t(other.allocator)
+{
+	if (other.first == other.inside())
+	{
+		for (item_t* i = other.begin(); i != other.end(); ++i)
+			traits_t::construct(allocator, first + count++, std::move(*i));
+		other.clear();
+	}
+	else
+	{
+		first = other.first;
+		count = other.count;
+		capacity = other.capacity;
+		other.first = other.inside();
+		other.count = 0;
+		other.capacity = inline_capacity;
+	}
+}
+
+template <class item_t, size_t inline_capacity, class allocator_t>
+small_vector_t<item_t, inline_capacity, allocator_t>& small_vector_t<item_t, inline_capacity, allocator_t>::operator=(
+	const small_vector_t& other)
+{
+	if (this == &other)
+		return *this;
+	clear();
+	reserve(other.count);
+	for (const item_t* i = other.begin(); i != other.end(); ++i)
+		traits_t::construct(allocator, first + count++, *i);
+	return *this;
+}
+
+/// Takes over the items of 'other', which is left empty; its memory too, if it comes from an equal allocator.
+template <class item_t, size_t inline_capacity, class allocator_t>
+small_vector_t<item_t, inline_capacity, allocator_t>& small_vector_t<item_t, inline_capacity, allocator_t>::operator=(
+	small_vector_t&& other)
+{
+	if (this == &other)
+		return *this;
+	if (other.first != other.inside() and allocator == other.allocator)
+	{
+		release();
+		first = other.first;
+		count = other.count;
+		capacity = other.capacity;
+		other.first = other.inside();
+		other.count = 0;
+		other.capacity = inline_capacity;
+		return *this;
+	}
+	clear();
+	reserve(other.count);
+	for (item_t* i = other.begin(); i != other.end(); ++i)
+		traits_t::construct(allocator, first + count++, std::move(*i));
+	other.clear();
+	return *this;
+}
+
+/// Destroys the items and returns the memory of the allocator, if any.
+template <class item_t, size_t inline_capacity, class allocator_t>
+void small_vector_t<item_t, inline_capacity, allocator_t>::release()
+{
+	clear();
+	if (first != inside())
+		traits_t::deallocate(allocator, first, capacity);
+	first = inside();
+	capacity = inline_capacity;
+}
+
+/// Moves the items to the memory of the allocator, for at least 'minimum' of them and at least twice as many as now.
+template <class item_t, size_t inline_capacity, class allocator_t>
+void small_vector_t<item_t, inline_capacity, allocator_t>::grow(size_t minimum)
+{
+	size_t new_capacity = std::max(minimum, static_cast<size_t>(capacity) * 2);
+	item_t* items = traits_t::allocate(allocator, new_capacity);
+	for (uint32_t i = 0; i < count; ++i)
+	{
+		traits_t::construct(allocator, items + i, std::move(first[i]));
+		traits_t::destroy(allocator, first + i);
+	}
+	if (first != inside())
+		traits_t::deallocate(allocator, first, capacity);
+	first = items;
+	capacity = static_cast<uint32_t>(new_capacity);
+}
+
+template <class item_t, size_t inline_capacity, class allocator_t>
+template <class... arguments_t>
+item_t& small_vector_t<item_t, inline_capacity, allocator_t>::emplace_back(arguments_t&&... arguments)
+{
+	if (count == capacity)
+	{
+		// The arguments may refer to an item, which the growth would move.
+		item_t item(std::forward<arguments_t>(arguments)...);
+		grow(count + 1);
+		traits_t::construct(allocator, first + count, std::move(item));
+	}
+	else
+		traits_t::construct(allocator, first + count, std::forward<arguments_t>(arguments)...);
+	return first[count++];
+}
+
+template <class item_t, size_t inline_capacity, class allocator_t>
+void small_vector_t<item_t, inline_capacity, allocator_t>::pop_back()
+{
+	traits_t::destroy(allocator, first + --count);
+}
+
+template <class item_t, size_t inline_capacity, class allocator_t>
+void small_vector_t<item_t, inline_capacity, allocator_t>::reserve(size_t minimum)
+{
+	if (minimum > capacity)
+		grow(minimum);
+}
+
+/// Destroys the items; the memory is kept for the next ones.
+template <class item_t, size_t inline_capacity, class allocator_t>
+void small_vector_t<item_t, inline_capacity, allocator_t>::clear()
+{
+	for (uint32_t i = 0; i < count; ++i)
+		traits_t::destroy(allocator, first + i);
+	count = 0;
+}
+
+template <class item_t, size_t inline_capacity, class allocator_t>
+void small_vector_t<item_t, inline_capacity, allocator_t>::swap(small_vector_t& other)
+{
+	small_vector_t moved(std::move(other));
+	other = std::move(*this);
+	*this = std::move(moved);
+}
+
+/// The sources of the memory of the outedges of my_graph; see graph_policy_t.
+enum class memory_t { heap, pool, arena };
+
+/// The containers of the outedges of a vertex of my_graph; see graph_policy_t.
+enum class adjacency_t { list, vector, small_vector };
+
+/** The default compile-time options of my_graph. A custom policy should derive from it
+* and redeclare only the options it changes.
+*/
+struct graph_policy_t
+{
+	// Whether every vertex keeps the ordinal numbers of the edges leading to it.
+	static constexpr bool inedges = false;
+	// Where the outedges are allocated: one by one on the heap; in the blocks of equal size pooled by the graph,
+	// which reuses the blocks of the erased edges; or in a monotonic arena of the graph, which reclaims nothing
+	// until the graph is cleared or destroyed, and then all at once.
+	static constexpr memory_t memory = memory_t::heap;
+	// The container of the outedges of a vertex: a list, in which an erasure keeps the order of the other edges; or
+	// an array, which is faster to traverse and in which the last edge takes the place of an erased one. The small
+	// array keeps up to 'inline_edges' edges inside the vertex, without an allocation of its own.
+	static constexpr adjacency_t adjacency = adjacency_t::list;
+	static constexpr size_t inline_edges = 4;
+};
+
+/// The policy of graphs that keep the lists of inedges, so that the queries about them cost O(indegree).
+struct bidirectional_policy_t : graph_policy_t
+{
+	static constexpr bool inedges = true;
+};
+
+/// The policy of graphs that allocate their outedges from a pool, for the graphs that change a lot.
+struct pool_policy_t : graph_policy_t
+{
+	static constexpr memory_t memory = memory_t::pool;
+};
+
+/// The policy of graphs that allocate their outedges from an arena, for the graphs built once and then queried.
+struct arena_policy_t : graph_policy_t
+{
+	static constexpr memory_t memory = memory_t::arena;
+};
+
+/// The policy of graphs that keep the outedges of every vertex in an array, for the traversal-heavy algorithms.
+struct vector_policy_t : graph_policy_t
+{
+	static constexpr adjacency_t adjacency = adjacency_t::vector;
+};
+
+/// The policy of graphs with few outedges per vertex, such as road networks, kept inside the vertices.
+struct small_vector_policy_t : graph_policy_t
+{
+	static constexpr adjacency_t adjacency = adjacency_t::small_vector;
+};
+
+/// The list of the ordinal numbers of the inedges of a vertex; empty unless the policy requests it.
+template <bool kept>
+struct inlist_t {};
+
+template <>
+struct inlist_t<true>
+{
+	std::vector<size_t> inedges;
+};
+
+/// Tells whether the keys of my_graph convert to std::string_view, so that they can be looked up by the views of a text.
+template <class key_t>
+constexpr bool textual_key_v = std::is_class_v<key_t> and std::is_convertible_v<const key_t&, std::string_view>;
+
+/// Hashes the keys of my_graph; the textual keys are hashed as std::string_view, to be found by the views too.
+template <class key_t, bool textual = textual_key_v<key_t>>
+struct key_hash_t : std::hash<key_t> {};
+
+template <class key_t>
+struct key_hash_t<key_t, true>
+{
+	using is_transparent = void;
+	size_t operator()(std::string_view key) const { return std::hash<std::string_view>()(key); }
+};
 
 /** Implements a directed, weighted graph that enables storing additional data for vertices.
 * Vertices are recognised by unique keys; key_t() should not be used as a key since it denotes
-* a special value 'undefined'. The weight type should be of a floating-point type because such
-* provides value infinity.
+* a special value 'undefined'. The weight type may be a floating-point type, whose infinity stands for
+* the cost of the paths to the unreachable vertices, or an integral type, whose greatest value does;
+* the costs of the paths must then stay below it. For the integral weights, the searches for the
+* shortest paths use the bucket heaps by default; see automatic_heap_t.
 * @param key_t - type of the keys of the vertices
 * @param data_t - type of the data assigned to the vertices
 * @param weight_t - type of the weights assigned to the edges
+* @param policy_t - compile-time options, derived from graph_policy_t
 */
-template <class key_t, class data_t, class weight_t = double>
+template <class key_t, class data_t, class weight_t = double, class policy_t = graph_policy_t>
 class my_graph
 {
 	struct edge_t
 	{
-		key_t head;
-		weight_t weight;
 		size_t ordinal;
-		edge_t(size_t _ordinal, key_t _head, weight_t _weight = 0.0)
+		uint32_t head;
+		weight_t weight;
+		edge_t(size_t _ordinal, uint32_t _head, weight_t _weight = weight_t())
 			: ordinal(_ordinal), head(_head), weight(_weight) {}
 	};
-	struct vertex_t
+	// The resource of the outedges, owned by the graph unless they are allocated on the heap.
+	using resource_t = std::conditional_t<policy_t::memory == memory_t::pool, std::pmr::unsynchronized_pool_resource,
+		std::conditional_t<policy_t::memory == memory_t::arena, std::pmr::monotonic_buffer_resource, std::pmr::memory_resource>>;
+	using edge_allocator_t = std::conditional_t<policy_t::memory == memory_t::heap, std::allocator<edge_t>,
+		std::pmr::polymorphic_allocator<edge_t>>;
+	using edges_t = std::conditional_t<policy_t::adjacency == adjacency_t::list, std::list<edge_t, edge_allocator_t>,
+		std::conditional_t<policy_t::adjacency == adjacency_t::vector, std::vector<edge_t, edge_allocator_t>,
+		small_vector_t<edge_t, policy_t::inline_edges, edge_allocator_t>>>;
+	// The place of an edge among the outedges of its tail: an iterator of the list, or a position in the array.
+	using place_t = std::conditional_t<policy_t::adjacency == adjacency_t::list, typename edges_t::iterator, uint32_t>;
+	struct vertex_t : inlist_t<policy_t::inedges>
 	{
 		data_t data;
-		std::list<edge_t> outedges;
-		vertex_t(data_t _data = data_t()) : data(_data), outedges() {}
+		edges_t outedges;
+		vertex_t(data_t _data, typename edges_t::allocator_type allocator) : data(_data), outedges(allocator) {}
+		vertex_t(const vertex_t& other, typename edges_t::allocator_type allocator)
+			: inlist_t<policy_t::inedges>(other), data(other.data), outedges(other.outedges, allocator) {}
+		// A copy allocates its outedges from the resource of the original, like the moved vertex.
+		vertex_t(const vertex_t& other) : vertex_t(other, other.outedges.get_allocator()) {}
+		// The vector of the vertices must move them when it grows, not copy them: the locations of the edges
+		// keep the iterators of the lists, which are valid only in the original. A throwing move terminates.
+		vertex_t(vertex_t&& other) noexcept = default;
+		vertex_t& operator=(const vertex_t& other) = default;
+		vertex_t& operator=(vertex_t&& other) = default;
+	};
+	static_assert(std::is_nothrow_move_constructible_v<vertex_t>, "the vertices must be moved, not copied, when the vector grows");
+	// The bijection between the keys and the dense indices of the vertices.
+	struct index_t
+	{
+		std::vector<key_t> keys;
+		std::unordered_map<key_t, uint32_t, key_hash_t<key_t>,
+			std::conditional_t<textual_key_v<key_t>, std::equal_to<>, std::equal_to<key_t>>> ids;
+		uint32_t find(key_t key) const;
+		uint32_t id(key_t key) const;
+	};
+
+	// The position of an edge: the index of its tail and its place among the outedges of the tail.
+	struct location_t
+	{
+		uint32_t tail;
+		place_t place;
+		location_t() : tail(no_vertex), place() {}
+		location_t(uint32_t _tail, place_t _place) : tail(_tail), place(_place) {}
 	};
 
-	std::unordered_map<key_t, vertex_t> incidences;
+	// The index is shared with the snapshots and the results computed on them;
+	// it is copied before a modification if it is not owned exclusively.
+	std::shared_ptr<index_t> index;
+	// Created on the first use; it outlives the vertices, whose outedges it holds.
+	std::unique_ptr<resource_t> resource;
+	// The vertices, in the order of their indices.
+	std::vector<vertex_t> vertices;
+	// The locations of the edges, indexed by their ordinal numbers; the erased edges have no tail.
+	std::vector<location_t> locations;
 	size_t graph_order, graph_size, edges_count;
+	// The number of the changes made to the graph; see version().
+	uint64_t graph_version;
+
+	// A special value of a dense vertex index that refers to no vertex.
+	static constexpr uint32_t no_vertex = std::numeric_limits<uint32_t>::max();
+
+	// A key as read from a text file: a view of the text for the textual keys, which are constructed
+	// only for the vertices inserted.
+	using token_t = std::conditional_t<textual_key_v<key_t>, std::string_view, key_t>;
+	// An edge read from a text file, before its endpoints are resolved.
+	struct record_t
+	{
+		token_t tail, head;
+		weight_t weight;
+	};
 
+	index_t& own_index();
+	typename edges_t::allocator_type allocator();
+	void reclaim();
+	void relocate();
+	uint32_t intern(const token_t& key);
+	static bool parse_line(const char* first, const char* last, edge_format_t format, record_t& record);
+	edge_t* locate(size_t number);
+	typename edges_t::iterator edge_at(const location_t& location);
+	place_t place_of(uint32_t tail, typename edges_t::iterator edge);
+	typename edges_t::iterator remove(uint32_t tail, typename edges_t::iterator edge);
+	void append(uint32_t tail, uint32_t head, weight_t weight);
+	void attach(uint32_t tail, uint32_t head, weight_t weight);
+	void detach(size_t number);
+	void unlink(uint32_t head, size_t number);
 
 public:
-	my_graph() : graph_order(0), graph_size(0), edges_count(0) {}
-	~my_graph() = default;
+	my_graph() : index(std::make_shared<index_t>()), locations(1), graph_order(0), graph_size(0), edges_count(0), graph_version(0) {}
+	my_graph(const my_graph& other);
+	my_graph(my_graph&& other) noexcept;
+	my_graph& operator=(const my_graph& other);
+	my_graph& operator=(my_graph&& other) noexcept;
+	~my_graph();
 	void print_graph();
 
 	// A special value that refers to no vertex in all the graphs of the template.
@@ -59,8 +1041,13 @@ public:
 	size_t outdegree(key_t key);
 	size_t degree(key_t key);
 	size_t degree();
-	void insert_edge(key_t tail, key_t head, weight_t weight = 0.0);
-	void insert_undirected_edge(key_t tail, key_t head, weight_t weight = 0.0);
+	void insert_edge(key_t tail, key_t head, weight_t weight = weight_t());
+	void insert_undirected_edge(key_t tail, key_t head, weight_t weight = weight_t());
+	template <class range_t> void insert_vertices(const range_t& range);
+	template <class range_t> void insert_edges(const range_t& range);
+	void reserve(size_t order, size_t size);
+	size_t load_edges(const std::string& path, edge_format_t format, size_t threads = 1,
+		std::function<void(size_t, size_t, size_t)> progress = nullptr);
 	std::vector<size_t> edges(key_t tail, key_t head);
 	std::vector<size_t> outedges(key_t tail);
 	std::vector<size_t> inedges(key_t head);
@@ -73,64 +1060,532 @@ public:
 	void reset_weight(size_t number, weight_t new_weight);
 	void reset_weight(size_t number, weight_t new_weight, key_t tail);
 	void reset_weights(key_t tail, key_t head, weight_t new_weight);
-	weight_t& edge_weight(size_t number);
-	weight_t& edge_weight(size_t number, key_t tail);
+	/// Refers to the weight of an edge; an assignment goes through reset_weight(), which announces the change.
+	class weight_reference_t
+	{
+		friend class my_graph;
+		my_graph* graph;
+		size_t number;
+		weight_reference_t(my_graph* _graph, size_t _number) : graph(_graph), number(_number) {}
+	public:
+		operator weight_t() const;
+		weight_reference_t& operator=(weight_t new_weight);
+		weight_reference_t& operator=(const weight_reference_t& other) { return *this = static_cast<weight_t>(other); }
+	};
+	weight_reference_t edge_weight(size_t number);
+	weight_reference_t edge_weight(size_t number, key_t tail);
 	void clear();
 
-	void breadth_first_search(std::function<void(key_t, data_t)> function, key_t source);
-	void depth_first_search(std::function<void(key_t, data_t)> function, key_t source);
+	template <class visitor_t> void breadth_first_search(visitor_t&& visitor, key_t source);
+	template <class visitor_t> void depth_first_search(visitor_t&& visitor, key_t source);
+
+	class snapshot_t;
+	class hierarchy_t;
+	snapshot_t freeze(bool with_data = true);
+	void save_binary(const std::string& path);
 
 	class OneToAll_t
 	{
-		friend OneToAll_t my_graph<key_t, data_t, weight_t>::Dijkstra(key_t);
-		friend OneToAll_t my_graph<key_t, data_t, weight_t>::Bellman_Ford(key_t);
-		key_t initial;
-		std::unordered_map<key_t, weight_t> distance;
-		std::unordered_map<key_t, key_t> predecessor;
+		friend class my_graph;
+		friend class snapshot_t;
+		std::shared_ptr<const index_t> index;
+		uint32_t initial;
+		std::vector<weight_t> distance;
+		std::vector<uint32_t> predecessor;
+		std::vector<size_t> via;
+		// The nearest source of every vertex, after a search from several sources; empty otherwise.
+		std::vector<uint32_t> origin;
 	public:
-		OneToAll_t() : initial(undefined) {};
-		OneToAll_t(key_t _initial) : initial(_initial) {};
-		weight_t path_cost(key_t terminal);
+		OneToAll_t() : index(), initial(no_vertex) {};
+		weight_t path_cost(key_t terminal) const;
+		std::vector<key_t> path_vertices(key_t terminal) const;
+		std::vector<size_t> path_edges(key_t terminal) const;
+		key_t nearest_source(key_t terminal) const;
+		void clear();
+	};
+	template <class heap_t = default_heap_t<weight_t>> OneToAll_t Dijkstra(key_t source);
+	OneToAll_t Bellman_Ford(key_t source, size_t threads = 1);
+	OneToAll_t delta_stepping(key_t source, weight_t delta = weight_t(), size_t threads = 1);
+	template <class heap_t = default_heap_t<weight_t>> OneToAll_t nearest_source_paths(const std::vector<key_t>& sources);
+
+	/** The solutions to the single-source shortest paths problem for several sources, kept in row-major
+	* matrices with a row for every source, in the order they were given, and a column for every vertex.
+	*/
+	class ManyToAll_t
+	{
+		friend class my_graph;
+		friend class snapshot_t;
+		std::shared_ptr<const index_t> index;
+		std::vector<uint32_t> sources;
+		// The row of every source; a source given more than once refers to its first row.
+		std::unordered_map<uint32_t, size_t> rows;
+		std::vector<weight_t> distance;
+		std::vector<uint32_t> predecessor;
+		std::vector<size_t> via;
+		size_t row(key_t source);
+	public:
+		ManyToAll_t() : index() {}
+		weight_t path_cost(key_t source, key_t terminal);
+		std::vector<key_t> path_vertices(key_t source, key_t terminal);
+		std::vector<size_t> path_edges(key_t source, key_t terminal);
+		void clear();
+	};
+	ManyToAll_t multi_source_shortest_paths(const std::vector<key_t>& sources, size_t threads = 1);
+
+	/// The breadth first tree of the vertices reachable from the initial one: their levels and parents.
+	class BreadthFirst_t
+	{
+		friend class my_graph;
+		friend class snapshot_t;
+		std::shared_ptr<const index_t> index;
+		uint32_t initial;
+		// The number of edges between the initial vertex and 'v', or 'no_vertex' if 'v' is unreachable.
+		std::vector<uint32_t> levels;
+		std::vector<uint32_t> parents;
+	public:
+		BreadthFirst_t() : index(), initial(no_vertex) {}
+		size_t level(key_t vertex);
+		key_t parent(key_t vertex);
 		std::vector<key_t> path_vertices(key_t terminal);
-		std::vector<size_t> path_edges(key_t terminal);
 		void clear();
 	};
-	OneToAll_t Dijkstra(key_t source);
-	OneToAll_t Bellman_Ford(key_t source);
+	BreadthFirst_t breadth_first_tree(key_t source, size_t threads = 1);
+
+	class OneToOne_t
+	{
+		friend class my_graph;
+		friend class snapshot_t;
+		std::shared_ptr<const index_t> index;
+		weight_t cost;
+		std::vector<uint32_t> vertices;
+		std::vector<size_t> edges;
+	public:
+		OneToOne_t() : index(), cost(infinity) {}
+		weight_t path_cost();
+		std::vector<key_t> path_vertices();
+		std::vector<size_t> path_edges();
+	};
+	template <class heap_t = default_heap_t<weight_t>> OneToOne_t shortest_path(key_t source, key_t target);
+	OneToOne_t bidirectional_path(key_t source, key_t target);
+	template <class heuristic_t> OneToOne_t A_star(key_t source, key_t target, heuristic_t heuristic);
 	
-	class AllToAll_t
+	/** The solution to the all-pairs shortest paths problem, kept in row-major matrices indexed by
+	* the dense indices of the vertices. A table with 'float' costs or 'uint16_t' hops takes less
+	* memory, at the price of precision or of the number of vertices (less than 65535).
+	*/
+	template <class cost_t = weight_t, class hop_t = uint32_t>
+	class AllToAll_table_t
 	{
-		friend OneToAll_t my_graph<key_t, data_t, weight_t>::Floyd_Warshall(key_t);
-		std::unordered_map<key_t, std::unordered_map<key_t, weight_t>> distance;
-		std::unordered_map<key_t, std::unordered_map<key_t, key_t>> successor;
+		friend class my_graph;
+		friend class snapshot_t;
+		static constexpr hop_t no_hop = std::numeric_limits<hop_t>::max();
+		std::shared_ptr<const index_t> index;
+		std::vector<cost_t> distance;
+		// The vertex following 'i' on the shortest path from 'i' to 'j', or 'no_hop'.
+		std::vector<hop_t> successor;
+		// The lightest edges between the adjacent vertices: the heads adjacent to vertex 'v' occupy
+		// the positions [offsets[v], offsets[v + 1]) of 'heads' in increasing order.
+		std::vector<size_t> offsets;
+		std::vector<uint32_t> heads;
+		std::vector<size_t> ordinals;
 	public:
-		AllToAll_t() = default;
-		weight_t path_cost(key_t initial, key_t terminal);
+		AllToAll_table_t() : index(), offsets(1, 0) {}
+		cost_t path_cost(key_t initial, key_t terminal);
 		std::vector<key_t> path_vertices(key_t initial, key_t terminal);
 		std::vector<size_t> path_edges(key_t initial, key_t terminal);
+		void clear();
+	};
+	using AllToAll_t = AllToAll_table_t<>;
+	template <class cost_t = weight_t, class hop_t = uint32_t>
+	AllToAll_table_t<cost_t, hop_t> Floyd_Warshall(size_t threads = 1);
+	template <class cost_t = weight_t, class hop_t = uint32_t>
+	AllToAll_table_t<cost_t, hop_t> Johnson(size_t threads = 1);
+	hierarchy_t contract(size_t threads = 1);
+
+	/** Single-source shortest paths kept up to date while the graph changes, created by my_graph::track().
+	* The graph announces its changes to the tracker, which repairs the tree of the shortest paths locally:
+	* an inserted edge or a decreased weight lets the improvement propagate from the head of the edge only
+	* as far as it reaches, and an erased edge or an increased weight of an edge of the tree recomputes only
+	* the subtree below it, entered from the rest of the tree through the inedges of the subtree (through
+	* all the edges, unless the policy keeps the inedges). A negative weight makes the tracker recompute
+	* the paths from scratch on the next query.
+	* Copies of the graph do not take over its trackers; a tracker of a destroyed graph answers no queries.
+	*/
+	class tracker_t
+	{
+		friend class my_graph;
+		my_graph* graph;
+		uint32_t initial;
+		bool stale;
+		std::vector<weight_t> distance;
+		std::vector<uint32_t> predecessor;
+		std::vector<size_t> via;
+		// The vertices waiting for the exploration of their outedges, with their distances at the time.
+		std::priority_queue<std::pair<weight_t, uint32_t>, std::vector<std::pair<weight_t, uint32_t>>,
+			std::greater<std::pair<weight_t, uint32_t>>> queue;
+		// The subtree being recomputed, marked in 'cut_off'.
+		std::vector<uint32_t> subtree;
+		std::vector<char> cut_off;
+		tracker_t(my_graph* _graph, uint32_t source) : graph(_graph), initial(source), stale(true) {}
+		void grow(size_t order);
+		void sync();
+		void recompute();
+		void propagate();
+		void improve(uint32_t tail, uint32_t head, weight_t weight, size_t ordinal);
+		void cut(uint32_t root);
+		void inserted(uint32_t tail, uint32_t head, weight_t weight, size_t ordinal);
+		void erased(uint32_t head, size_t ordinal);
+		void reweighted(uint32_t tail, uint32_t head, weight_t weight, weight_t new_weight, size_t ordinal);
+		void moved(uint32_t victim, uint32_t last);
+		void lost();
+	public:
+		weight_t path_cost(key_t terminal);
+		std::vector<key_t> path_vertices(key_t terminal);
+		std::vector<size_t> path_edges(key_t terminal);
+	};
+	std::shared_ptr<tracker_t> track(key_t source);
+
+	/** Cache of the single-source shortest paths of one graph, keyed by the algorithm and the source, that
+	* evicts the least recently used results to keep their memory within a budget. The results are shared
+	* with the callers and are never changed; once the version of the graph differs from the one they were
+	* computed for, all of them are dropped on the next query. The tuning parameters of an algorithm (the heap,
+	* 'delta', the number of the threads) do not change the distances, so they are not part of the key.
+	* The graph keeps track of its caches: they follow it when it is moved, and are detached when it is
+	* destroyed or assigned to, after which their queries throw.
+	*/
+	class cache_t
+	{
+		friend class my_graph;
+		enum algorithm_t : uint64_t { Dijkstra_algorithm, Bellman_Ford_algorithm, delta_stepping_algorithm };
+		struct entry_t
+		{
+			uint64_t key;
+			std::shared_ptr<const OneToAll_t> result;
+			size_t bytes;
+		};
+		my_graph* graph;
+		uint64_t version;
+		size_t budget, bytes;
+		// The entries from the most recently used to the least recently used, and their places by the key.
+		std::list<entry_t> entries;
+		std::unordered_map<uint64_t, typename std::list<entry_t>::iterator> places;
+		size_t hits, misses, evictions, invalidations;
+		void evict(size_t room);
+		template <class compute_t>
+		std::shared_ptr<const OneToAll_t> lookup(algorithm_t algorithm, key_t source, compute_t compute);
+	public:
+		struct statistics_t
+		{
+			size_t hits, misses, evictions, invalidations;
+			// The current number of the cached results and the memory they take, in bytes.
+			size_t entries, bytes;
+		};
+		cache_t(my_graph& _graph, size_t _budget);
+		cache_t(const cache_t&) = delete;
+		cache_t& operator=(const cache_t&) = delete;
+		~cache_t();
+		template <class heap_t = default_heap_t<weight_t>> std::shared_ptr<const OneToAll_t> Dijkstra(key_t source);
+		std::shared_ptr<const OneToAll_t> Bellman_Ford(key_t source, size_t threads = 1);
+		std::shared_ptr<const OneToAll_t> delta_stepping(key_t source, weight_t delta = weight_t(), size_t threads = 1);
+		void reset_budget(size_t new_budget);
+		statistics_t statistics();
+		void clear();
+	};
+
+	/** Immutable compressed-sparse-row image of the graph, compiled by my_graph::freeze()
+	* or mapped from a binary file by snapshot_t::open_mapped().
+	* The vertices are numbered densely from 0; the outedges of vertex 'v' occupy the positions
+	* [offsets[v], offsets[v + 1]) of the arrays 'heads', 'weights' and 'ordinals'.
+	* The snapshot does not follow later modifications of the graph it was compiled from.
+	* Copies of a snapshot share its arrays.
+	*/
+	class snapshot_t
+	{
+		friend class my_graph;
+		// The arrays of a compiled snapshot.
+		struct buffers_t
+		{
+			std::vector<data_t> data;
+			std::vector<size_t> offsets;
+			std::vector<uint32_t> heads;
+			std::vector<weight_t> weights;
+			std::vector<size_t> ordinals;
+			buffers_t() : offsets(1, 0) {}
+		};
+		// A mapped file, together with the data that could not be mapped directly.
+		struct mapped_t
+		{
+			file_mapping_t file;
+			std::vector<data_t> data;
+			mapped_t(const std::string& path) : file(path) {}
+		};
+		// The header of the binary file format; the sections are aligned to 64 bytes.
+		struct header_t
+		{
+			char signature[8];
+			uint32_t version, endianness;
+			uint32_t index_width, weight_width, key_width, data_width;
+			uint64_t order, size;
+			uint64_t offsets_at, heads_at, weights_at, ordinals_at, data_at, keys_at;
+			uint32_t data_format, reserved;
+		};
+		enum : uint32_t { no_data = 0, raw_data = 1, serialised_data = 2 };
+		static constexpr uint32_t format_version = 1;
+		// The facts derived from the arrays on first use and shared by the copies of the snapshot.
+		// The inedges of vertex 'v' occupy the positions [offsets[v], offsets[v + 1]) of 'tails'
+		// and 'positions', the latter referring to the positions of the edges in the arrays above.
+		struct derived_t
+		{
+			std::once_flag signs_once, reverse_once;
+			bool negative = false;
+			weight_t heaviest = weight_t();
+			std::vector<size_t> offsets;
+			std::vector<uint32_t> tails;
+			std::vector<size_t> positions;
+		};
+
+		// The owner of the memory that the pointers below refer to: buffers_t or mapped_t.
+		std::shared_ptr<const void> storage;
+		std::shared_ptr<const index_t> index;
+		const data_t* data;
+		const size_t* offsets;
+		const uint32_t* heads;
+		const weight_t* weights;
+		const size_t* ordinals;
+		std::shared_ptr<derived_t> derived;
+		snapshot_t(std::shared_ptr<const index_t> _index, std::shared_ptr<const buffers_t> buffers);
+		bool negative();
+		weight_t heaviest();
+		const derived_t& reverse();
+		// Translates the events of a search over the indices of the vertices into the calls of 'visitor':
+		// a callable taking the key and the data of every discovered vertex, or a search_visitor_t.
+		template <class visitor_t, class payload_t>
+		struct search_events_t
+		{
+			using data_ref_t = decltype(std::declval<payload_t&>()(uint32_t()));
+			static constexpr bool plain = std::is_invocable_v<visitor_t&, const key_t&, data_ref_t>;
+			const key_t* keys;
+			const uint32_t* heads;
+			const weight_t* weights;
+			visitor_t& visitor;
+			payload_t payload;
+			template <class call_t>
+			static bool proceed(call_t call)
+			{
+				if constexpr (std::is_void_v<decltype(call())>)
+				{
+					call();
+					return true;
+				}
+				else
+					return call();
+			}
+			bool discover(uint32_t v)
+			{
+				return proceed([&]()
+				{
+					if constexpr (plain)
+						return visitor(keys[v], payload(v));
+					else
+						return visitor.discover_vertex(keys[v], payload(v));
+				});
+			}
+			bool examine(size_t e, uint32_t tail)
+			{
+				if constexpr (plain)
+					return true;
+				else
+					return proceed([&]() { return visitor.examine_edge(keys[tail], keys[heads[e]], weights[e]); });
+			}
+			bool tree(size_t e, uint32_t tail)
+			{
+				if constexpr (plain)
+					return true;
+				else
+					return proceed([&]() { return visitor.tree_edge(keys[tail], keys[heads[e]], weights[e]); });
+			}
+			bool finish(uint32_t v)
+			{
+				if constexpr (plain)
+					return true;
+				else
+					return proceed([&]() { return visitor.finish_vertex(keys[v], payload(v)); });
+			}
+		};
+		template <class visitor_t, class payload_t>
+		search_events_t<visitor_t, payload_t> events(visitor_t& visitor, payload_t payload)
+		{
+			return search_events_t<visitor_t, payload_t>{ index->keys.data(), heads, weights, visitor, payload };
+		}
+		template <class events_t> void breadth_first_ids(events_t& events, uint32_t source);
+		template <class events_t> void depth_first_ids(events_t& events, uint32_t source);
+		OneToAll_t solution(uint32_t initial, std::vector<weight_t>& distance,
+			std::vector<uint32_t>& predecessor, std::vector<size_t>& via);
+		template <class select_t>
+		void relax(const std::vector<uint32_t>& frontier, select_t select, size_t threads, std::vector<weight_t>& distance,
+			std::vector<uint32_t>& predecessor, std::vector<size_t>& via, std::vector<std::vector<uint32_t>>& improved);
+		OneToOne_t route(uint32_t initial, uint32_t terminal, weight_t cost,
+			const std::vector<uint32_t>& predecessor, const std::vector<size_t>& via);
+		template <class heuristic_t, class payload_t>
+		OneToOne_t A_star_ids(uint32_t initial, uint32_t terminal, heuristic_t& heuristic, payload_t datum);
+		std::vector<weight_t> potentials();
+		void lightest_edges(std::vector<size_t>& lightest_offsets, std::vector<uint32_t>& lightest_heads,
+			std::vector<size_t>& lightest_ordinals);
+		// The side of the square tiles of the blocked Floyd-Warshall algorithm.
+		static constexpr size_t tile = 64;
+		template <class cost_t, class hop_t>
+		static void relax_tile(cost_t* distance, hop_t* successor, size_t n, size_t row, size_t column, size_t pivot);
+		// The number of the sources searched together by multi_source_shortest_paths().
+		static constexpr size_t lanes = 8;
+	public:
+		snapshot_t() : snapshot_t(std::make_shared<index_t>(), std::make_shared<buffers_t>()) {}
+		size_t order();
+		size_t size();
+		void save_binary(const std::string& path);
+		static snapshot_t open_mapped(const std::string& path);
+		template <class visitor_t> void breadth_first_search(visitor_t&& visitor, key_t source);
+		template <class visitor_t> void depth_first_search(visitor_t&& visitor, key_t source);
+		BreadthFirst_t breadth_first_tree(key_t source, size_t threads = 1);
+		template <class heap_t = default_heap_t<weight_t>> OneToAll_t Dijkstra(key_t source);
+		OneToAll_t Bellman_Ford(key_t source, size_t threads = 1);
+		OneToAll_t delta_stepping(key_t source, weight_t delta = weight_t(), size_t threads = 1);
+		template <class heap_t = default_heap_t<weight_t>> OneToAll_t nearest_source_paths(const std::vector<key_t>& sources);
+		ManyToAll_t multi_source_shortest_paths(const std::vector<key_t>& sources, size_t threads = 1);
+		template <class heap_t = default_heap_t<weight_t>> OneToOne_t shortest_path(key_t source, key_t target);
+		OneToOne_t bidirectional_path(key_t source, key_t target);
+		template <class heuristic_t> OneToOne_t A_star(key_t source, key_t target, heuristic_t heuristic);
+		template <class cost_t = weight_t, class hop_t = uint32_t>
+		AllToAll_table_t<cost_t, hop_t> Floyd_Warshall(size_t threads = 1);
+		template <class cost_t = weight_t, class hop_t = uint32_t>
+		AllToAll_table_t<cost_t, hop_t> Johnson(size_t threads = 1);
+		hierarchy_t contract(size_t threads = 1);
+	};
+
+	/** Contraction hierarchy of a snapshot, built by snapshot_t::contract() to answer many point-to-point
+	* queries on an unchanging graph. The vertices are ranked in the order of their contraction; every arc
+	* is either the lightest edge from one vertex to another or a shortcut standing for two consecutive arcs
+	* through a vertex of lower rank than both its ends. A query searches only upward from both ends and
+	* unpacks the shortcuts of the path it finds into the original edges.
+	*/
+	class hierarchy_t
+	{
+		friend class my_graph;
+		friend class snapshot_t;
+		struct arc_t
+		{
+			uint32_t tail, head;
+			weight_t weight;
+			// An edge: its ordinal number and 'no_arc'; a shortcut: the indices of the two arcs it replaces.
+			size_t first, second;
+		};
+		// The header of the binary file format; the sections follow in the order of the fields.
+		struct header_t
+		{
+			char signature[8];
+			uint32_t version, endianness;
+			uint32_t index_width, weight_width;
+			uint64_t order, arcs, up, down;
+		};
+		static constexpr size_t no_arc = std::numeric_limits<size_t>::max();
+		static constexpr uint32_t format_version = 1;
+
+		std::shared_ptr<const index_t> index;
+		std::vector<uint32_t> rank;
+		std::vector<arc_t> arcs;
+		// The arcs from vertex 'v' to the vertices of higher rank occupy [up_offsets[v], up_offsets[v + 1])
+		// of 'up'; the arcs into 'v' from the vertices of higher rank occupy the same range of 'down'.
+		std::vector<size_t> up_offsets, down_offsets;
+		std::vector<uint32_t> up, down;
+		void unpack(size_t arc, std::vector<size_t>& edges);
+	public:
+		hierarchy_t() : index(std::make_shared<index_t>()), up_offsets(1, 0), down_offsets(1, 0) {}
+		size_t shortcuts();
+		OneToOne_t shortest_path(key_t source, key_t target);
+		void save_binary(const std::string& path);
+		static hierarchy_t load_binary(const std::string& path, snapshot_t graph);
 	};
-	AllToAll_t Floyd_Warshall();
 
 	bool empty();
+	uint64_t version();
 
 	enum class mode { serial, bfs, dfs };
+	/** Forward iterator over the keys of the vertices in the serial (index), breadth first or depth first
+	* order. A search proceeds one vertex per increment, so only the part of the graph that is actually
+	* iterated over is explored; when no more vertices are reachable, it is resumed from the unvisited vertex
+	* of the lowest index, like breadth_first_search(). Any modification of the graph invalidates the iterators.
+	*/
 	class iterator
 	{
-		std::shared_ptr<my_graph<key_t, data_t, weight_t>> the_graph;
-		std::shared_ptr<std::pair<key_t, vertex_t>> the_vertex;
+		friend class my_graph;
+		const my_graph* graph;
+		mode flag;
+		// The current vertex, or 'no_vertex' past the end.
+		uint32_t vertex;
+		// No vertex below 'cursor' is left unvisited.
+		uint32_t cursor;
+		std::vector<uint64_t> visited;
+		// The breadth first search: the discovered vertices from position 'front', beginning with the current one.
+		std::vector<uint32_t> queue;
+		size_t front;
+		// The depth first search: the path to the current vertex and the next outedge of each of its vertices.
+		std::vector<std::pair<uint32_t, typename edges_t::const_iterator>> stack;
+		iterator(const my_graph* _graph, mode _flag, uint32_t source);
+		bool marked(uint32_t v) const { return (visited[v / 64] >> (v % 64) & 1) != 0; }
+		void discover(uint32_t v);
+		void restart();
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = key_t;
+		using difference_type = std::ptrdiff_t;
+		using pointer = const key_t*;
+		using reference = const key_t&;
+		iterator() : graph(nullptr), flag(mode::serial), vertex(no_vertex), cursor(0), front(0) {}
+		reference operator*() const { return graph->index->keys[vertex]; }
+		pointer operator->() const { return &graph->index->keys[vertex]; }
+		iterator& operator++();
+		iterator operator++(int);
+		bool operator==(const iterator& other) const { return vertex == other.vertex; }
+		bool operator!=(const iterator& other) const { return vertex != other.vertex; }
+	};
+	/// The vertices of the graph in one of the orders of 'mode', as a view for range-based loops and std::ranges.
+	class view_t : public std::ranges::view_interface<view_t>
+	{
+		friend class my_graph;
+		const my_graph* graph;
 		mode flag;
+		uint32_t source;
+		view_t(const my_graph* _graph, mode _flag, uint32_t _source) : graph(_graph), flag(_flag), source(_source) {}
+	public:
+		view_t() : graph(nullptr), flag(mode::serial), source(no_vertex) {}
+		iterator begin() const { return source == no_vertex ? iterator() : iterator(graph, flag, source); }
+		iterator end() const { return iterator(); }
 	};
+	view_t serial();
+	view_t bfs(key_t source);
+	view_t dfs(key_t source);
+
+private:
+	// The trackers created by track(); the expired ones are dropped when the next change is announced.
+	std::vector<std::weak_ptr<tracker_t>> trackers;
+	// The caches of the shortest paths, which register and unregister themselves.
+	std::vector<cache_t*> caches;
+	// The snapshot without the data that the searches share while the version of the graph stays 'image_version'.
+	std::optional<snapshot_t> image;
+	uint64_t image_version = 0;
+	template <class event_t> void notify(event_t event);
+	void release();
+	snapshot_t compiled();
 };
 
-template <class key_t, class data_t, class weight_t>
-key_t my_graph<key_t, data_t, weight_t>::undefined = key_t();
+template <class key_t, class data_t, class weight_t, class policy_t>
+key_t my_graph<key_t, data_t, weight_t, policy_t>::undefined = key_t();
 
-template <class key_t, class data_t, class weight_t>
-weight_t my_graph<key_t, data_t, weight_t>::infinity = std::numeric_limits<weight_t>::infinity();
+template <class key_t, class data_t, class weight_t, class policy_t>
+weight_t my_graph<key_t, data_t, weight_t, policy_t>::infinity = infinite_cost<weight_t>();
 
 /// Enumeration class for errors, used as argument to class 'error_t' constructor.
 enum class problem_t { out_of_range = 1, empty_graph, invalid_value, negative_weight, no_path,
-	negative_cycle };
+	negative_cycle, io_failure };
 
 /// Class used for throwing exceptions.
 class error_t : public std::exception
@@ -154,827 +1609,4249 @@ public:
 			return "No path.";
 		case problem_t::negative_cycle:
 			return "Negative cycle.";
+		case problem_t::io_failure:
+			return "Input/output failure.";
 		default:
 			return "Unknown problem.";
 		}
 	}
-};
-
-/// Prints the graph to the console.
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::print_graph()
-{
-	if (incidences.empty())
-	{
-		std::cout << "empty graph" << std::endl;
-		return;
-	}
-	std::cout << "order = " << graph_order << ", size = " << graph_size << ";" << std::endl
-		<< "(key)\t{data}\toutedges: [ordinal|head:weight]" << std::endl;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+};
+
+/** Maps the file at 'path' into memory for reading.
+* @throw error_t(problem_t::io_failure) - if the file cannot be opened or mapped
+*/
+inline file_mapping_t::file_mapping_t(const std::string& path) : view(nullptr), length(0)
+{
+#ifdef _WIN32
+	mapping = nullptr;
+	file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+		FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+		throw error_t(problem_t::io_failure);
+	LARGE_INTEGER file_size;
+	if (not GetFileSizeEx(file, &file_size))
+	{
+		CloseHandle(file);
+		throw error_t(problem_t::io_failure);
+	}
+	// An empty file cannot be mapped; it is read as an empty range.
+	if (file_size.QuadPart == 0)
+		return;
+	length = static_cast<size_t>(file_size.QuadPart);
+	mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping != nullptr)
+		view = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (view == nullptr)
+	{
+		if (mapping != nullptr)
+			CloseHandle(mapping);
+		CloseHandle(file);
+		throw error_t(problem_t::io_failure);
+	}
+#else
+	file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		throw error_t(problem_t::io_failure);
+	struct stat status;
+	if (fstat(file, &status) != 0)
+	{
+		close(file);
+		throw error_t(problem_t::io_failure);
+	}
+	// An empty file cannot be mapped; it is read as an empty range.
+	if (status.st_size == 0)
+		return;
+	length = static_cast<size_t>(status.st_size);
+	void* address = mmap(nullptr, length, PROT_READ, MAP_SHARED, file, 0);
+	if (address == MAP_FAILED)
+	{
+		close(file);
+		throw error_t(problem_t::io_failure);
+	}
+	view = static_cast<const char*>(address);
+#endif
+}
+
+inline file_mapping_t::~file_mapping_t()
+{
+#ifdef _WIN32
+	if (view != nullptr)
+	{
+		UnmapViewOfFile(view);
+		CloseHandle(mapping);
+	}
+	CloseHandle(file);
+#else
+	if (view != nullptr)
+		munmap(const_cast<char*>(view), length);
+	close(file);
+#endif
+}
+
+/// Tells whether write_binary() and read_binary() support the type: trivially copyable types and strings thereof.
+template <class item_t>
+struct serialisable_t : std::is_trivially_copyable<item_t> {};
+
+template <class char_t, class traits_t, class allocator_t>
+struct serialisable_t<std::basic_string<char_t, traits_t, allocator_t>> : std::is_trivially_copyable<char_t> {};
+
+/// Writes 'item' to a binary stream; a string is preceded by its length.
+template <class item_t>
+void write_binary(std::ostream& stream, const item_t& item)
+{
+	if constexpr (std::is_trivially_copyable_v<item_t>)
+		stream.write(reinterpret_cast<const char*>(&item), sizeof(item_t));
+	else
+	{
+		uint64_t length = item.size();
+		stream.write(reinterpret_cast<const char*>(&length), sizeof(length));
+		stream.write(reinterpret_cast<const char*>(item.data()), length * sizeof(typename item_t::value_type));
+	}
+}
+
+/** Reads 'item' written by write_binary() from the memory at 'cursor' and advances the cursor.
+* @throw error_t(problem_t::invalid_value) - if the item would extend past 'end'
+*/
+template <class item_t>
+void read_binary(const char*& cursor, const char* end, item_t& item)
+{
+	if constexpr (std::is_trivially_copyable_v<item_t>)
+	{
+		if (static_cast<size_t>(end - cursor) < sizeof(item_t))
+			throw error_t(problem_t::invalid_value);
+		std::memcpy(&item, cursor, sizeof(item_t));
+		cursor += sizeof(item_t);
+	}
+	else
+	{
+		uint64_t length;
+		read_binary(cursor, end, length);
+		if (static_cast<size_t>(end - cursor) / sizeof(typename item_t::value_type) < length)
+			throw error_t(problem_t::invalid_value);
+		item.resize(static_cast<size_t>(length));
+		std::memcpy(&item[0], cursor, static_cast<size_t>(length) * sizeof(typename item_t::value_type));
+		cursor += length * sizeof(typename item_t::value_type);
+	}
+}
+
+/** Reads 'item' from the text in [first, last): numbers are converted, other types are constructed
+* from the characters.
+* @return 'true' if the whole text was read, 'false' otherwise
+*/
+template <class item_t>
+bool parse_text(const char* first, const char* last, item_t& item)
+{
+	if constexpr (std::is_arithmetic_v<item_t>)
+	{
+		std::from_chars_result result = std::from_chars(first, last, item);
+		return result.ec == std::errc() and result.ptr == last;
+	}
+	else
+	{
+		item = item_t(first, last);
+		return first != last;
+	}
+}
+
+/** Looks up the index of vertex 'key'.
+* @return the index of the vertex, or 'no_vertex' if it is absent
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+uint32_t my_graph<key_t, data_t, weight_t, policy_t>::index_t::find(key_t key) const
+{
+	auto i = ids.find(key);
+	return i == ids.end() ? no_vertex : i->second;
+}
+
+/** Looks up the index of vertex 'key'.
+* @return the index of the vertex
+* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+uint32_t my_graph<key_t, data_t, weight_t, policy_t>::index_t::id(key_t key) const
+{
+	auto i = ids.find(key);
+	if (i == ids.end())
+		throw error_t(problem_t::out_of_range);
+	return i->second;
+}
+
+/// Returns the index of the graph for modification, copying it first if it is shared.
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::index_t& my_graph<key_t, data_t, weight_t, policy_t>::own_index()
+{
+	// The cached snapshot shares the index and is out of date once it changes.
+	image.reset();
+	if (index.use_count() > 1)
+		index = std::make_shared<index_t>(*index);
+	return *index;
+}
+
+/// Returns the allocator of the outedges of the new vertices.
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::edges_t::allocator_type my_graph<key_t, data_t, weight_t, policy_t>::allocator()
+{
+	if constexpr (policy_t::memory == memory_t::heap)
+		return typename edges_t::allocator_type();
+	else
+	{
+		if (not resource)
+			resource = std::make_unique<resource_t>();
+		return typename edges_t::allocator_type(resource.get());
+	}
+}
+
+/// Destroys the vertices and returns the memory of their outedges to the resource of the graph, at once.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::reclaim()
+{
+	vertices.clear();
+	if constexpr (policy_t::memory != memory_t::heap)
+	{
+		if (resource)
+			resource->release();
+	}
+}
+
+/// Points the locations of the edges at the outedges of this graph, after they were copied from another one.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::relocate()
+{
+	for (uint32_t v = 0; v < vertices.size(); ++v)
+	{
+		for (auto o = vertices[v].outedges.begin(); o != vertices[v].outedges.end(); ++o)
+			locations[o->ordinal].place = place_of(v, o);
+	}
+}
+
+/// Announces a change of the graph: increases its version and informs the trackers, dropping the expired ones.
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class event_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::notify(event_t event)
+{
+	++graph_version;
+	for (size_t t = 0; t < trackers.size(); )
+	{
+		if (std::shared_ptr<tracker_t> tracker = trackers[t].lock())
+		{
+			event(*tracker);
+			++t;
+		}
+		else
+		{
+			trackers[t] = trackers.back();
+			trackers.pop_back();
+		}
+	}
+}
+
+/// Detaches the trackers, to which the graph announces no more changes, and the caches.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::release()
+{
+	for (auto t = trackers.begin(); t != trackers.end(); ++t)
+	{
+		if (std::shared_ptr<tracker_t> tracker = t->lock())
+			tracker->graph = nullptr;
+	}
+	trackers.clear();
+	for (auto c = caches.begin(); c != caches.end(); ++c)
+		(*c)->graph = nullptr;
+	caches.clear();
+}
+
+/// Copies the graph without its trackers and caches.
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::my_graph(const my_graph& other)
+	: index(other.index), locations(other.locations), graph_order(other.graph_order),
+	graph_size(other.graph_size), edges_count(other.edges_count), graph_version(other.graph_version)
+{
+	vertices.reserve(other.vertices.size());
+	for (auto i = other.vertices.begin(); i != other.vertices.end(); ++i)
+		vertices.emplace_back(*i, allocator());
+	relocate();
+}
+
+/// Moves the graph together with its trackers and caches, leaving 'other' empty.
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::my_graph(my_graph&& other) noexcept
+	: index(std::move(other.index)), resource(std::move(other.resource)), vertices(std::move(other.vertices)),
+	locations(std::move(other.locations)),
+	graph_order(other.graph_order), graph_size(other.graph_size), edges_count(other.edges_count),
+	graph_version(other.graph_version), trackers(std::move(other.trackers)), caches(std::move(other.caches)),
+	image(std::move(other.image)), image_version(other.image_version)
+{
+	for (auto t = trackers.begin(); t != trackers.end(); ++t)
+	{
+		if (std::shared_ptr<tracker_t> tracker = t->lock())
+			tracker->graph = this;
+	}
+	for (auto c = caches.begin(); c != caches.end(); ++c)
+		(*c)->graph = this;
+	other.clear();
+}
+
+/// Copies 'other' without its trackers and caches; the trackers and the caches of this graph are detached.
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>& my_graph<key_t, data_t, weight_t, policy_t>::operator=(const my_graph& other)
+{
+	if (this == &other)
+		return *this;
+	release();
+	image.reset();
+	index = other.index;
+	reclaim();
+	vertices.reserve(other.vertices.size());
+	for (auto i = other.vertices.begin(); i != other.vertices.end(); ++i)
+		vertices.emplace_back(*i, allocator());
+	locations = other.locations;
+	graph_order = other.graph_order;
+	graph_size = other.graph_size;
+	edges_count = other.edges_count;
+	graph_version = std::max(graph_version, other.graph_version) + 1;
+	relocate();
+	return *this;
+}
+
+/// Moves 'other' together with its trackers and caches, leaving it empty; the trackers and the caches of this graph are detached.
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>& my_graph<key_t, data_t, weight_t, policy_t>::operator=(my_graph&& other) noexcept
+{
+	if (this == &other)
+		return *this;
+	release();
+	image.reset();
+	index = std::move(other.index);
+	vertices = std::move(other.vertices);
+	resource = std::move(other.resource);
+	locations = std::move(other.locations);
+	graph_order = other.graph_order;
+	graph_size = other.graph_size;
+	edges_count = other.edges_count;
+	graph_version = std::max(graph_version, other.graph_version) + 1;
+	trackers = std::move(other.trackers);
+	for (auto t = trackers.begin(); t != trackers.end(); ++t)
+	{
+		if (std::shared_ptr<tracker_t> tracker = t->lock())
+			tracker->graph = this;
+	}
+	caches = std::move(other.caches);
+	for (auto c = caches.begin(); c != caches.end(); ++c)
+		(*c)->graph = this;
+	other.clear();
+	return *this;
+}
+
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::~my_graph()
+{
+	release();
+}
+
+/** Looks up the edge with ordinal 'number' in constant time.
+* @return pointer to the edge, or nullptr if there is no such edge
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::edge_t* my_graph<key_t, data_t, weight_t, policy_t>::locate(size_t number)
+{
+	if (number >= locations.size() or locations[number].tail == no_vertex)
+		return nullptr;
+	return &*edge_at(locations[number]);
+}
+
+/// Returns the iterator over the outedges of the tail of an edge that points at the edge.
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::edges_t::iterator my_graph<key_t, data_t, weight_t, policy_t>::edge_at(
+	const location_t& location)
+{
+	if constexpr (policy_t::adjacency == adjacency_t::list)
+		return location.place;
+	else
+		return vertices[location.tail].outedges.begin() + location.place;
+}
+
+/// Returns the place of 'edge' among the outedges of 'tail' to be kept in its location.
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::place_t my_graph<key_t, data_t, weight_t, policy_t>::place_of(
+	uint32_t tail, typename edges_t::iterator edge)
+{
+	if constexpr (policy_t::adjacency == adjacency_t::list)
+		return edge;
+	else
+		return static_cast<uint32_t>(edge - vertices[tail].outedges.begin());
+}
+
+/** Removes 'edge' from the outedges of 'tail'; in an array, the last edge is moved to its place.
+* The location of the removed edge is left to the caller.
+* @return the iterator at the edge that follows the removed one, or at the moved edge
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::edges_t::iterator my_graph<key_t, data_t, weight_t, policy_t>::remove(
+	uint32_t tail, typename edges_t::iterator edge)
+{
+	edges_t& outedges = vertices[tail].outedges;
+	if constexpr (policy_t::adjacency == adjacency_t::list)
+		return outedges.erase(edge);
+	else
+	{
+		size_t place = edge - outedges.begin();
+		if (place + 1 != outedges.size())
+		{
+			*edge = std::move(outedges.back());
+			locations[edge->ordinal].place = static_cast<uint32_t>(place);
+		}
+		outedges.pop_back();
+		return outedges.begin() + place;
+	}
+}
+
+/// Appends a new edge to the outedges of 'tail' and registers its location, without announcing it.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::append(uint32_t tail, uint32_t head, weight_t weight)
+{
+	edges_t& outedges = vertices[tail].outedges;
+	outedges.emplace_back(edge_t(++edges_count, head, weight));
+	locations.emplace_back(tail, place_of(tail, std::prev(outedges.end())));
+	if constexpr (policy_t::inedges)
+		vertices[head].inedges.push_back(edges_count);
+	++graph_size;
+}
+
+/// Appends a new edge to the outedges of 'tail' and announces it.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::attach(uint32_t tail, uint32_t head, weight_t weight)
+{
+	append(tail, head, weight);
+	notify([&](tracker_t& tracker) { tracker.inserted(tail, head, weight, edges_count); });
+}
+
+/// Erases the existing edge with ordinal 'number' in constant time.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::detach(size_t number)
+{
+	location_t& location = locations[number];
+	uint32_t head = edge_at(location)->head;
+	unlink(head, number);
+	remove(location.tail, edge_at(location));
+	location.tail = no_vertex;
+	--graph_size;
+	notify([&](tracker_t& tracker) { tracker.erased(head, number); });
+}
+
+/// Removes the edge with ordinal 'number' from the inedges of 'head', if the policy keeps them.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::unlink(uint32_t head, size_t number)
+{
+	if constexpr (policy_t::inedges)
+	{
+		std::vector<size_t>& inedges = vertices[head].inedges;
+		auto i = std::find(inedges.begin(), inedges.end(), number);
+		*i = inedges.back();
+		inedges.pop_back();
+	}
+}
+
+/// Returns the index of vertex 'key', inserting the vertex first if it is absent.
+template<class key_t, class data_t, class weight_t, class policy_t>
+uint32_t my_graph<key_t, data_t, weight_t, policy_t>::intern(const token_t& key)
+{
+	auto found = index->ids.find(key);
+	if (found != index->ids.end())
+		return found->second;
+	index_t& own = own_index();
+	uint32_t vertex = static_cast<uint32_t>(vertices.size());
+	own.keys.push_back(key_t(key));
+	own.ids.emplace(own.keys.back(), vertex);
+	vertices.emplace_back(data_t(), allocator());
+	++graph_order;
+	++graph_version;
+	return vertex;
+}
+
+/// Prints the graph to the console.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::print_graph()
+{
+	if (vertices.empty())
+	{
+		std::cout << "empty graph" << std::endl;
+		return;
+	}
+	std::cout << "order = " << graph_order << ", size = " << graph_size << ";" << std::endl
+		<< "(key)\t{data}\toutedges: [ordinal|head:weight]" << std::endl;
+	for (uint32_t i = 0; i < vertices.size(); ++i)
+	{
+		std::cout << "(" << index->keys[i] << ")\t{" << vertices[i].data << "}\t";
+		if (vertices[i].outedges.empty())
+			std::cout << "<none>";
+		else
+			for (auto o = vertices[i].outedges.begin(); o != vertices[i].outedges.end(); ++o)
+				std::cout << "[" << o->ordinal << "|" << index->keys[o->head] << ":" << o->weight << "] ";
+		std::cout << std::endl;
+	}
+}
+
+/** Inserts vertex 'key', provided such key is not yet present in the graph,
+* and assigns it with 'data', that is equal to data_t() by default.
+* @param key_t key - the key that should be inserted
+* @param data_t data - the data that should be assigned to the vertex
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::insert_vertex(key_t key, data_t data)
+{
+	if (index->find(key) != no_vertex)
+		return;
+	index_t& own = own_index();
+	own.ids.emplace(key, static_cast<uint32_t>(vertices.size()));
+	own.keys.push_back(key);
+	vertices.emplace_back(data, allocator());
+	++graph_order;
+	++graph_version;
+}
+
+/** Erases vertex 'key' and all edges incident on it.
+* The last vertex takes over the index of the erased one, so that the indices remain dense.
+* @param key_t key - the key of the vertex that should be erased
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::erase_vertex(key_t key)
+{
+	uint32_t victim = index->find(key);
+	if (victim == no_vertex)
+		return;
+	uint32_t last = static_cast<uint32_t>(vertices.size() - 1);
+	erase_outedges(key);
+	erase_inedges(key);
+	if constexpr (policy_t::inedges)
+	{
+		for (auto i = vertices[last].inedges.begin(); i != vertices[last].inedges.end(); ++i)
+			edge_at(locations[*i])->head = victim;
+	}
+	else
+	{
+		for (auto i = vertices.begin(); i != vertices.end(); ++i)
+		{
+			for (auto o = i->outedges.begin(); o != i->outedges.end(); ++o)
+			{
+				if (o->head == last)
+					o->head = victim;
+			}
+		}
+	}
+	index_t& own = own_index();
+	own.ids.erase(key);
+	if (victim != last)
+	{
+		vertices[victim].data = std::move(vertices[last].data);
+		vertices[victim].outedges.swap(vertices[last].outedges);
+		if constexpr (policy_t::inedges)
+			vertices[victim].inedges.swap(vertices[last].inedges);
+		for (auto o = vertices[victim].outedges.begin(); o != vertices[victim].outedges.end(); ++o)
+			locations[o->ordinal].tail = victim;
+		own.keys[victim] = std::move(own.keys[last]);
+		own.ids[own.keys[victim]] = victim;
+	}
+	vertices.pop_back();
+	own.keys.pop_back();
+	--graph_order;
+	notify([&](tracker_t& tracker) { tracker.moved(victim, last); });
+}
+
+/** Replaces 'key' with 'new_key'; the data and the edges of the vertex are preserved.
+* @param key_t key - the key to be replaced
+* @param key_t new_key - the key to replace with
+* @throw error_t(problem_t::out_of_range) - if 'key' is absent in the graph
+* @throw error_t(problem_t::invalid_value) - if 'new_key' is already present in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::reset_key(key_t key, key_t new_key)
+{
+	if (key == new_key)
+		return;
+	uint32_t vertex = index->id(key);
+	if (index->find(new_key) != no_vertex)
+		throw error_t(problem_t::invalid_value);
+	index_t& own = own_index();
+	own.ids.erase(key);
+	own.ids.emplace(new_key, vertex);
+	own.keys[vertex] = new_key;
+	++graph_version;
+}
+
+/** Resets the data assigned to vertex 'key'.
+* @param key_t key - the key of the vertex whose data should be reset
+* @param data_t new_data - the new data that should be assigned to the vertex
+* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::reset_data(key_t key, data_t new_data)
+{
+	vertices[index->id(key)].data = new_data;
+}
+
+/** Returns reference to the data assigned to vertex 'key'.
+* @param key_t key - the vertex whose data should be accessed
+* @return reference to the data
+* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+data_t& my_graph<key_t, data_t, weight_t, policy_t>::vertex_data(key_t key)
+{
+	return vertices[index->id(key)].data;
+}
+
+/** Counts the input degree of vertex 'key'.
+* @param key_t key - the vertex whose input degree should be counted
+* @return the number of edges leading to the vertex
+* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::indegree(key_t key)
+{
+	uint32_t vertex = index->id(key);
+	if constexpr (policy_t::inedges)
+		return vertices[vertex].inedges.size();
+	else
+	{
+		size_t count = 0;
+		for (auto i = vertices.begin(); i != vertices.end(); ++i)
+		{
+			for (auto o = i->outedges.begin(); o != i->outedges.end(); ++o)
+			{
+				if (o->head == vertex)
+					++count;
+			}
+		}
+		return count;
+	}
+}
+
+/** Counts the output degree of vertex 'key'.
+* @param key_t key - the vertex whose output degree should be counted
+* @return the number of edges going out from the vertex
+* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::outdegree(key_t key)
+{
+	return vertices[index->id(key)].outedges.size();
+}
+
+/** Counts the degree of vertex 'key'.
+* @param key_t key - the vertex whose degree should be counted
+* @return the number of edges incident on the vertex
+* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::degree(key_t key)
+{
+	return outdegree(key) + indegree(key);
+}
+
+/** Counts the degrees of the vertices and returns the greatest one.
+* @return degree of the graph
+* @throw error_t(problem_t::empty_graph) - if the graph is empty
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::degree()
+{
+	if (vertices.empty())
+		throw error_t(problem_t::empty_graph);
+	std::vector<size_t> counts(vertices.size(), 0);
+	for (uint32_t i = 0; i < vertices.size(); ++i)
+	{
+		counts[i] += vertices[i].outedges.size();
+		if constexpr (policy_t::inedges)
+			counts[i] += vertices[i].inedges.size();
+		else
+		{
+			for (auto o = vertices[i].outedges.begin(); o != vertices[i].outedges.end(); ++o)
+				++counts[o->head];
+		}
+	}
+	return *std::max_element(counts.begin(), counts.end());
+}
+
+/** Inserts an edge from 'tail' to 'head', provided such vertices are present in the graph,
+ * and assigns it with 'weight', that is equal to weight_t() by default.
+ * @param key_t tail - the initial vertex of the edge
+ * @param key_t head - the terminal vertex of the edge
+ * @param weight_t weight - the weight that should be assigned to the edge
+ * @throw error_t(problem_t::out_of_range) - if vertices 'tail' and 'head' are absent in the graph
+ */
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::insert_edge(key_t tail, key_t head, weight_t weight)
+{
+	uint32_t from = index->id(tail), to = index->id(head);
+	attach(from, to, weight);
+}
+
+ /** Inserts two edges: from 'tail' to 'head' and from 'head' to 'tail',
+* and assigns them with 'weight', that is equal to weight_t() by default.
+* @param key_t tail - an endpoint of the edges
+* @param key_t head - the other endpoint of the edges
+* @param weight_t weight - the weight that should be assigned to the edges
+* @throw error_t(problem_t::out_of_range) - if vertices 'tail' and 'head' are absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::insert_undirected_edge(key_t tail, key_t head, weight_t weight)
+{
+	uint32_t from = index->id(tail), to = index->id(head);
+	attach(from, to, weight);
+	attach(to, from, weight);
+}
+
+/** Inserts the vertices of 'range' that are not yet present in the graph. The storage for all of them
+* is reserved in advance.
+* @param range_t range - a forward range of keys, or of pairs (key, data)
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class range_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::insert_vertices(const range_t& range)
+{
+	size_t count = std::distance(std::begin(range), std::end(range));
+	index_t& own = own_index();
+	own.ids.reserve(own.ids.size() + count);
+	own.keys.reserve(own.keys.size() + count);
+	vertices.reserve(vertices.size() + count);
+	for (auto i = std::begin(range); i != std::end(range); ++i)
+	{
+		using element_t = std::decay_t<decltype(*i)>;
+		if constexpr (std::is_convertible_v<element_t, key_t>)
+			insert_vertex(*i);
+		else
+			insert_vertex(std::get<0>(*i), std::get<1>(*i));
+	}
+}
+
+/** Inserts the edges of 'range', assigning them consecutive ordinal numbers. All the endpoints are
+* validated before any edge is inserted, so that on failure the graph is left unchanged.
+* @param range_t range - a forward range of tuples (tail, head, weight) or (tail, head)
+* @throw error_t(problem_t::out_of_range) - if an endpoint of any edge is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class range_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::insert_edges(const range_t& range)
+{
+	std::vector<std::pair<uint32_t, uint32_t>> ends;
+	ends.reserve(std::distance(std::begin(range), std::end(range)));
+	for (auto i = std::begin(range); i != std::end(range); ++i)
+		ends.emplace_back(index->id(std::get<0>(*i)), index->id(std::get<1>(*i)));
+	locations.reserve(locations.size() + ends.size());
+	if constexpr (policy_t::inedges)
+	{
+		std::vector<size_t> counts(vertices.size(), 0);
+		for (auto e = ends.begin(); e != ends.end(); ++e)
+			++counts[e->second];
+		for (uint32_t v = 0; v < vertices.size(); ++v)
+			vertices[v].inedges.reserve(vertices[v].inedges.size() + counts[v]);
+	}
+	auto e = ends.begin();
+	for (auto i = std::begin(range); i != std::end(range); ++i, ++e)
+	{
+		using element_t = std::decay_t<decltype(*i)>;
+		if constexpr (std::tuple_size_v<element_t> > 2)
+			attach(e->first, e->second, std::get<2>(*i));
+		else
+			attach(e->first, e->second, weight_t());
+	}
+}
+
+/** Reserves the storage for 'order' vertices and 'size' edges in total, so that building the graph
+* up to that size does not reallocate the tables.
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::reserve(size_t order, size_t size)
+{
+	index_t& own = own_index();
+	own.ids.reserve(order);
+	own.keys.reserve(order);
+	vertices.reserve(order);
+	locations.reserve(edges_count + 1 + (size > graph_size ? size - graph_size : 0));
+}
+
+/** Reads one line of an edge list.
+* @param const char* first, const char* last - the line, without the line feed
+* @return 'true' if the line describes an edge, 'false' if it is blank or should be skipped
+* @throw error_t(problem_t::invalid_value) - if the line is malformed
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+bool my_graph<key_t, data_t, weight_t, policy_t>::parse_line(const char* first, const char* last,
+	edge_format_t format, record_t& record)
+{
+	auto blank = [](char c) { return c == ' ' or c == '\t' or c == '\r'; };
+	while (first < last and blank(*first))
+		++first;
+	while (last > first and blank(last[-1]))
+		--last;
+	if (first == last or *first == '#')
+		return false;
+	if (format == edge_format_t::DIMACS)
+	{
+		if (*first != 'a')
+			return false;
+		++first;
+	}
+	std::pair<const char*, const char*> fields[3];
+	size_t count = 0;
+	while (first < last and count < 3)
+	{
+		while (first < last and blank(*first))
+			++first;
+		const char* begin = first;
+		if (format == edge_format_t::CSV)
+		{
+			while (first < last and *first != ',')
+				++first;
+			const char* end = first;
+			while (end > begin and blank(end[-1]))
+				--end;
+			fields[count++] = std::make_pair(begin, end);
+			if (first < last)
+				++first;
+		}
+		else
+		{
+			while (first < last and not blank(*first))
+				++first;
+			fields[count++] = std::make_pair(begin, first);
+		}
+	}
+	record.weight = weight_t();
+	if (count < 2 or not parse_text(fields[0].first, fields[0].second, record.tail)
+		or not parse_text(fields[1].first, fields[1].second, record.head)
+		or (count > 2 and not parse_text(fields[2].first, fields[2].second, record.weight)))
+		throw error_t(problem_t::invalid_value);
+	return true;
+}
+
+/** Reads the edges from a text file and inserts them into the graph, together with the vertices
+* that are not yet present. The file is mapped into memory and processed in windows; each window
+* is split at line boundaries into slices parsed concurrently, after which the edges are inserted
+* in the order of the file. The textual keys are looked up by the views of the text and constructed
+* only for the new vertices; the trackers learn of each window at once and recompute their paths.
+* @param const std::string& path - the path of the file
+* @param edge_format_t format - the format of the file
+* @param size_t threads - the number of the parsing threads
+* @param progress - called after each window with the numbers of the bytes read, of all the bytes
+* and of the edges inserted so far
+* @return the number of the edges inserted
+* @throw error_t(problem_t::io_failure) - if the file cannot be read
+* @throw error_t(problem_t::invalid_value) - if a line is malformed; the edges of the preceding
+* windows remain inserted
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::load_edges(const std::string& path, edge_format_t format,
+	size_t threads, std::function<void(size_t, size_t, size_t)> progress)
+{
+	file_mapping_t file(path);
+	const char* begin = file.begin();
+	const char* end = begin + file.size();
+	threads = std::max<size_t>(threads, 1);
+	if (format == edge_format_t::DIMACS)
+	{
+		const char* line = begin;
+		while (line < end and *line != 'p' and *line != 'a')
+		{
+			line = std::find(line, end, '\n');
+			line = line == end ? end : line + 1;
+		}
+		if (line < end and *line == 'p')
+		{
+			// "p sp <order> <size>"
+			const char* last = std::find(line, end, '\n');
+			size_t numbers[2] = { 0, 0 };
+			const char* cursor = std::find(line, last, ' ');
+			cursor = std::find(cursor + (cursor < last), last, ' ');
+			for (size_t n = 0; n < 2 and cursor < last; ++n)
+			{
+				while (cursor < last and *cursor == ' ')
+					++cursor;
+				cursor = std::from_chars(cursor, last, numbers[n]).ptr;
+			}
+			reserve(numbers[0], graph_size + numbers[1]);
+		}
+	}
+	const size_t slice_length = size_t(1) << 24;
+	std::vector<std::vector<record_t>> records(threads);
+	// The endpoints of the edges of a window, and the numbers of the edges added to each vertex.
+	std::vector<std::pair<uint32_t, uint32_t>> ends;
+	std::vector<uint32_t> added;
+	size_t count = 0;
+	for (const char* window = begin; window < end; )
+	{
+		std::vector<const char*> bounds(1, window);
+		for (size_t t = 0; t < threads; ++t)
+		{
+			const char* bound = static_cast<size_t>(end - bounds.back()) > slice_length ? bounds.back() + slice_length : end;
+			bound = std::find(bound, end, '\n');
+			bounds.push_back(bound == end ? end : bound + 1);
+		}
+		parallel_for(threads, threads, [&](size_t t)
+		{
+			records[t].clear();
+			bool header = format == edge_format_t::CSV and bounds[t] == begin;
+			record_t record;
+			for (const char* line = bounds[t]; line < bounds[t + 1]; )
+			{
+				const char* last = std::find(line, bounds[t + 1], '\n');
+				bool parsed = false;
+				try
+				{
+					parsed = parse_line(line, last, format, record);
+				}
+				catch (error_t&)
+				{
+					if (not header)
+						throw;
+				}
+				if (parsed)
+					records[t].push_back(std::move(record));
+				if (parsed or (header and line != last and *line != '#'))
+					header = false;
+				line = last == bounds[t + 1] ? last : last + 1;
+			}
+		});
+		// The endpoints are resolved in the order of the file, which numbers the new vertices; the edges of
+		// each vertex are then reserved at once, appended, and announced to the trackers once for the window.
+		ends.clear();
+		for (size_t t = 0; t < threads; ++t)
+		{
+			for (auto r = records[t].begin(); r != records[t].end(); ++r)
+			{
+				uint32_t tail = intern(r->tail);
+				ends.emplace_back(tail, intern(r->head));
+			}
+		}
+		added.resize(vertices.size(), 0);
+		if constexpr (policy_t::adjacency != adjacency_t::list)
+		{
+			for (auto e = ends.begin(); e != ends.end(); ++e)
+				++added[e->first];
+			for (auto e = ends.begin(); e != ends.end(); ++e)
+			{
+				if (added[e->first] != 0)
+					vertices[e->first].outedges.reserve(vertices[e->first].outedges.size() + added[e->first]);
+				added[e->first] = 0;
+			}
+		}
+		if constexpr (policy_t::inedges)
+		{
+			for (auto e = ends.begin(); e != ends.end(); ++e)
+				++added[e->second];
+			for (auto e = ends.begin(); e != ends.end(); ++e)
+			{
+				if (added[e->second] != 0)
+					vertices[e->second].inedges.reserve(vertices[e->second].inedges.size() + added[e->second]);
+				added[e->second] = 0;
+			}
+		}
+		locations.reserve(locations.size() + ends.size());
+		auto e = ends.begin();
+		for (size_t t = 0; t < threads; ++t)
+		{
+			for (auto r = records[t].begin(); r != records[t].end(); ++r, ++e)
+				append(e->first, e->second, r->weight);
+		}
+		count += ends.size();
+		if (not ends.empty())
+			notify([](tracker_t& tracker) { tracker.stale = true; });
+		window = bounds.back();
+		if (progress)
+			progress(static_cast<size_t>(window - begin), file.size(), count);
+	}
+	return count;
+}
+
+/** Returns the ordinal numbers of edges from 'tail' to 'head'.
+* @param key_t tail - the initial vertex of the edges
+* @param key_t head - the terminal vertex of the edges
+* @return the vector of ordinal numbers of the edges
+* @throw error_t(problem_t::out_of_range) - if 'tail' or 'head' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::edges(key_t tail, key_t head)
+{
+	uint32_t from = index->id(tail), to = index->id(head);
+	std::vector<size_t> numbers;
+	for (auto o = vertices[from].outedges.begin(); o != vertices[from].outedges.end(); ++o)
+	{
+		if (o->head == to)
+			numbers.push_back(o->ordinal);
+	}
+	return numbers;
+}
+
+/** Returns the ordinal numbers of edges outgoing from 'tail'.
+* @param key_t tail - the initial vertex of the edges
+* @return the vector of ordinal numbers of the edges
+* @throw error_t(problem_t::out_of_range) - if 'tail' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::outedges(key_t tail)
+{
+	uint32_t from = index->id(tail);
+	std::vector<size_t> numbers;
+	for (auto o = vertices[from].outedges.begin(); o != vertices[from].outedges.end(); ++o)
+		numbers.push_back(o->ordinal);
+	return numbers;
+}
+
+/** Returns the ordinal numbers of edges leading to 'head'.
+* @param key_t head - the terminal vertex of the edges
+* @return the vector of ordinal numbers of the edges
+* @throw error_t(problem_t::out_of_range) - if 'head' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::inedges(key_t head)
+{
+	uint32_t to = index->id(head);
+	if constexpr (policy_t::inedges)
+		return vertices[to].inedges;
+	else
+	{
+		std::vector<size_t> numbers;
+		for (auto i = vertices.begin(); i != vertices.end(); ++i)
+		{
+			for (auto o = i->outedges.begin(); o != i->outedges.end(); ++o)
+			{
+				if (o->head == to)
+					numbers.push_back(o->ordinal);
+			}
+		}
+		return numbers;
+	}
+}
+
+/** Finds the edge of the least weight from 'tail' to 'head'.
+* @return the ordinal number of the edge, or 0 if no edge joins the vertices
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::shortest_edge(key_t tail, key_t head)
+{
+	uint32_t from = index->find(tail), to = index->find(head);
+	if (from == no_vertex or to == no_vertex)
+		return 0;
+	size_t number = 0;
+	weight_t weight = infinity;
+	for (auto o = vertices[from].outedges.begin(); o != vertices[from].outedges.end(); ++o)
+	{
+		if (o->head == to and (number == 0 or o->weight < weight))
+		{
+			number = o->ordinal;
+			weight = o->weight;
+		}
+	}
+	return number;
+}
+
+/** Erases the edge with ordinal 'number'. The edge is found in constant time.
+* @param size_t number - the identifier of the edge that should be erased
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::erase_edge(size_t number)
+{
+	if (locate(number) == nullptr)
+		return;
+	detach(number);
+}
+
+/** Erases the edge with ordinal 'number', provided it goes out from 'tail'.
+* @param size_t number - the identifier of the edge that should be erased
+* @param key_t tail - the initial vertex of the edge
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::erase_edge(size_t number, key_t tail)
+{
+	uint32_t from = index->find(tail);
+	if (from == no_vertex or locate(number) == nullptr or locations[number].tail != from)
+		return;
+	detach(number);
+}
+
+/** Erases all the edges from vertex 'tail' to 'head'.
+* If no such vertices are present in the graph, nothing is done.
+* @param key_t tail - the initial vertex of the edge
+* @param key_t head - the terminal vertex of the edge
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::erase_edges(key_t tail, key_t head)
+{
+	uint32_t from = index->find(tail), to = index->find(head);
+	if (from == no_vertex or to == no_vertex)
+		return;
+	std::vector<size_t> erased;
+	auto o = vertices[from].outedges.begin();
+	while (o != vertices[from].outedges.end())
+	{
+		if (o->head == to)
+		{
+			unlink(to, o->ordinal);
+			locations[o->ordinal].tail = no_vertex;
+			--graph_size;
+			if (not trackers.empty())
+				erased.push_back(o->ordinal);
+			o = remove(from, o);
+		}
+		else
+			++o;
+	}
+	for (auto number = erased.begin(); number != erased.end(); ++number)
+		notify([&](tracker_t& tracker) { tracker.erased(to, *number); });
+}
+
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::erase_inedges(key_t head)
+{
+	uint32_t to = index->find(head);
+	if (to == no_vertex)
+		return;
+	std::vector<size_t> erased;
+	if constexpr (policy_t::inedges)
+	{
+		for (auto i = vertices[to].inedges.begin(); i != vertices[to].inedges.end(); ++i)
+		{
+			location_t& location = locations[*i];
+			remove(location.tail, edge_at(location));
+			location.tail = no_vertex;
+			--graph_size;
+		}
+		if (not trackers.empty())
+			erased.swap(vertices[to].inedges);
+		vertices[to].inedges.clear();
+	}
+	else
+	{
+		for (auto i = vertices.begin(); i != vertices.end(); ++i)
+		{
+			auto o = i->outedges.begin();
+			while (o != i->outedges.end())
+			{
+				if (o->head == to)
+				{
+					locations[o->ordinal].tail = no_vertex;
+					--graph_size;
+					if (not trackers.empty())
+						erased.push_back(o->ordinal);
+					o = remove(static_cast<uint32_t>(i - vertices.begin()), o);
+				}
+				else
+					++o;
+			}
+		}
+	}
+	for (auto number = erased.begin(); number != erased.end(); ++number)
+		notify([&](tracker_t& tracker) { tracker.erased(to, *number); });
+}
+
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::erase_outedges(key_t tail)
+{
+	uint32_t from = index->find(tail);
+	if (from == no_vertex)
+		return;
+	std::vector<std::pair<uint32_t, size_t>> erased;
+	for (auto o = vertices[from].outedges.begin(); o != vertices[from].outedges.end(); ++o)
+	{
+		unlink(o->head, o->ordinal);
+		locations[o->ordinal].tail = no_vertex;
+		if (not trackers.empty())
+			erased.emplace_back(o->head, o->ordinal);
+	}
+	graph_size -= vertices[from].outedges.size();
+	vertices[from].outedges.clear();
+	for (auto e = erased.begin(); e != erased.end(); ++e)
+		notify([&](tracker_t& tracker) { tracker.erased(e->first, e->second); });
+}
+
+/** Resets the weight of the edge with ordinal 'number'. If the edge was erased, nothing is done.
+* @throw error_t(problem_t::out_of_range) - if no edge has ever been given ordinal 'number'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::reset_weight(size_t number, weight_t new_weight)
+{
+	if (number > edges_count)
+		throw error_t(problem_t::out_of_range);
+	if (edge_t* edge = locate(number))
+	{
+		weight_t weight = edge->weight;
+		edge->weight = new_weight;
+		notify([&](tracker_t& tracker) { tracker.reweighted(locations[number].tail, edge->head, weight, new_weight, number); });
+	}
+}
+
+/** Resets the weight of the edge with ordinal 'number', provided it goes out from 'tail'.
+* @throw error_t(problem_t::out_of_range) - if no edge has ever been given ordinal 'number'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::reset_weight(size_t number, weight_t new_weight, key_t tail)
+{
+	if (number > edges_count)
+		throw error_t(problem_t::out_of_range);
+	uint32_t from = index->find(tail);
+	edge_t* edge = locate(number);
+	if (from != no_vertex and edge != nullptr and locations[number].tail == from)
+	{
+		weight_t weight = edge->weight;
+		edge->weight = new_weight;
+		notify([&](tracker_t& tracker) { tracker.reweighted(from, edge->head, weight, new_weight, number); });
+	}
+}
+
+/** Resets the weight of the edge from 'tail' to 'head'.
+* If no such are present in the graph or no edge joins them, nothing is done.
+* If more than one such edges are present, the weights of all of them are reset.
+* @param key_t tail
+* @param key_t head
+* @param weight_t new_weight
+* @throw
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::reset_weights(key_t tail, key_t head, weight_t new_weight)
+{
+	uint32_t from = index->id(tail), to = index->id(head);
+	for (auto it = vertices[from].outedges.begin(); it != vertices[from].outedges.end(); ++it)
+	{
+		if (it->head == to)
+		{
+			weight_t weight = it->weight;
+			it->weight = new_weight;
+			notify([&](tracker_t& tracker) { tracker.reweighted(from, to, weight, new_weight, it->ordinal); });
+		}
+	}
+}
+
+/** Returns reference to the weight of the edge with ordinal 'number'.
+* @throw error_t(problem_t::out_of_range) - if there is no such edge
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::weight_reference_t my_graph<key_t, data_t, weight_t, policy_t>::edge_weight(
+	size_t number)
+{
+	if (locate(number) == nullptr)
+		throw error_t(problem_t::out_of_range);
+	return weight_reference_t(this, number);
+}
+
+/** Returns reference to the weight of the edge with ordinal 'number' going out from 'tail'.
+* @throw error_t(problem_t::out_of_range) - if there is no such edge
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::weight_reference_t my_graph<key_t, data_t, weight_t, policy_t>::edge_weight(
+	size_t number, key_t tail)
+{
+	uint32_t from = index->id(tail);
+	if (locate(number) == nullptr or locations[number].tail != from)
+		throw error_t(problem_t::out_of_range);
+	return weight_reference_t(this, number);
+}
+
+/** Reads the weight of the edge.
+* @throw error_t(problem_t::out_of_range) - if the edge has been erased
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::weight_reference_t::operator weight_t() const
+{
+	edge_t* edge = graph->locate(number);
+	if (edge == nullptr)
+		throw error_t(problem_t::out_of_range);
+	return edge->weight;
+}
+
+/// Resets the weight of the edge, unless it has been erased; see reset_weight().
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::weight_reference_t&
+my_graph<key_t, data_t, weight_t, policy_t>::weight_reference_t::operator=(weight_t new_weight)
+{
+	graph->reset_weight(number, new_weight);
+	return *this;
+}
+
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::clear()
+{
+	image.reset();
+	index = std::make_shared<index_t>();
+	reclaim();
+	locations.assign(1, location_t());
+	graph_order = 0;
+	graph_size = 0;
+	edges_count = 0;
+	notify([](tracker_t& tracker) { tracker.lost(); });
+}
+
+/** Performs breadth first search algorithm on the graph, beginning with vertex 'source'. When no more vertices
+* are reachable, the search is resumed from the unvisited vertex of the lowest index.
+* @param visitor_t visitor - a callable invoked with 'const key_t&' and 'data_t&' of each vertex, or a
+* search_visitor_t; a callable returning bool stops the search by returning false
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class visitor_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::breadth_first_search(visitor_t&& visitor, key_t source)
+{
+	if (vertices.empty())
+		return;
+	uint32_t initial = index->id(source);
+	snapshot_t snapshot = compiled();
+	auto events = snapshot.events(visitor, [this](uint32_t vertex) -> data_t& { return vertices[vertex].data; });
+	snapshot.breadth_first_ids(events, initial);
+}
+
+/** Performs depth first search algorithm on the graph, beginning with vertex 'source'; see breadth_first_search().
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class visitor_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::depth_first_search(visitor_t&& visitor, key_t source)
+{
+	if (vertices.empty())
+		return;
+	uint32_t initial = index->id(source);
+	snapshot_t snapshot = compiled();
+	auto events = snapshot.events(visitor, [this](uint32_t vertex) -> data_t& { return vertices[vertex].data; });
+	snapshot.depth_first_ids(events, initial);
+}
+
+/** Builds the breadth first tree of the vertices reachable from 'source'; see snapshot_t::breadth_first_tree().
+* @param size_t threads - the number of threads expanding each level
+* @return an object containing the tree
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::BreadthFirst_t my_graph<key_t, data_t, weight_t, policy_t>::breadth_first_tree(
+	key_t source, size_t threads)
+{
+	return compiled().breadth_first_tree(source, threads);
+}
+
+/// Returns the vertices of the graph in the order of their indices.
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::view_t my_graph<key_t, data_t, weight_t, policy_t>::serial()
+{
+	return view_t(this, mode::serial, vertices.empty() ? no_vertex : 0);
+}
+
+/** Returns the vertices of the graph in the breadth first order, beginning with vertex 'source'.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::view_t my_graph<key_t, data_t, weight_t, policy_t>::bfs(key_t source)
+{
+	return view_t(this, mode::bfs, index->id(source));
+}
+
+/** Returns the vertices of the graph in the depth first order, beginning with vertex 'source'.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::view_t my_graph<key_t, data_t, weight_t, policy_t>::dfs(key_t source)
+{
+	return view_t(this, mode::dfs, index->id(source));
+}
+
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::iterator::iterator(const my_graph* _graph, mode _flag, uint32_t source)
+	: graph(_graph), flag(_flag), vertex(source), cursor(0), front(0)
+{
+	if (flag != mode::serial)
+	{
+		visited.assign((graph->vertices.size() + 63) / 64, 0);
+		discover(source);
+	}
+}
+
+/// Marks vertex 'v' as visited and schedules it for the exploration of its outedges.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::iterator::discover(uint32_t v)
+{
+	visited[v / 64] |= uint64_t(1) << (v % 64);
+	if (flag == mode::bfs)
+		queue.push_back(v);
+	else
+		stack.emplace_back(v, graph->vertices[v].outedges.cbegin());
+}
+
+/// Resumes the search from the unvisited vertex of the lowest index, or moves past the end if there is none.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::iterator::restart()
+{
+	const size_t n = graph->vertices.size();
+	while (cursor < n and marked(cursor))
+		cursor = visited[cursor / 64] == ~uint64_t(0) ? (cursor / 64 + 1) * 64 : cursor + 1;
+	if (cursor < n)
+	{
+		discover(cursor);
+		vertex = cursor;
+	}
+	else
+		vertex = no_vertex;
+}
+
+/// Moves to the next vertex, exploring the graph no further than it is needed to find it.
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::iterator& my_graph<key_t, data_t, weight_t, policy_t>::iterator::operator++()
+{
+	if (flag == mode::serial)
+	{
+		vertex = vertex + 1 < graph->vertices.size() ? vertex + 1 : no_vertex;
+		return *this;
+	}
+	if (flag == mode::bfs)
+	{
+		const edges_t& outedges = graph->vertices[queue[front++]].outedges;
+		for (auto e = outedges.begin(); e != outedges.end(); ++e)
+		{
+			if (not marked(e->head))
+				discover(e->head);
+		}
+		// The explored vertices are dropped once they make up the larger part of the queue.
+		if (front > queue.size() / 2)
+		{
+			queue.erase(queue.begin(), queue.begin() + front);
+			front = 0;
+		}
+		if (front < queue.size())
+			vertex = queue[front];
+		else
+			restart();
+		return *this;
+	}
+	while (not stack.empty())
+	{
+		auto& top = stack.back();
+		if (top.second == graph->vertices[top.first].outedges.cend())
+		{
+			stack.pop_back();
+			continue;
+		}
+		uint32_t head = (top.second++)->head;
+		if (not marked(head))
+		{
+			discover(head);
+			vertex = head;
+			return *this;
+		}
+	}
+	restart();
+	return *this;
+}
+
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::iterator my_graph<key_t, data_t, weight_t, policy_t>::iterator::operator++(int)
+{
+	iterator previous = *this;
+	++*this;
+	return previous;
+}
+
+/** Solves the shortest paths problem from the nearest of several sources; see snapshot_t::nearest_source_paths().
+* @param heap_t - the priority queue, instantiated with weight_t; see default_heap_t
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if any of 'sources' is absent in the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heap_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::nearest_source_paths(
+	const std::vector<key_t>& sources)
+{
+	return compiled().template nearest_source_paths<heap_t>(sources);
+}
+
+/** Solves the single-source shortest paths problem for several sources at once; see
+* snapshot_t::multi_source_shortest_paths().
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solutions to the problem
+* @throw error_t(problem_t::out_of_range) - if any of 'sources' is absent in the graph
+* @throw error_t(problem_t::negative_cycle) - if a cycle of negative weight is reachable from any of 'sources'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::ManyToAll_t my_graph<key_t, data_t, weight_t, policy_t>::multi_source_shortest_paths(
+	const std::vector<key_t>& sources, size_t threads)
+{
+	return compiled().multi_source_shortest_paths(sources, threads);
+}
+
+/** Solves the single-source shortest paths problem by means of the Dijkstra's algorithm and keeps the
+* solution up to date while the graph changes; see tracker_t.
+* @return the tracker, which stops following the graph once the last copy of the pointer is gone
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::shared_ptr<typename my_graph<key_t, data_t, weight_t, policy_t>::tracker_t> my_graph<key_t, data_t, weight_t, policy_t>::track(
+	key_t source)
+{
+	std::shared_ptr<tracker_t> tracker(new tracker_t(this, index->id(source)));
+	tracker->sync();
+	trackers.push_back(tracker);
+	return tracker;
+}
+
+/** Creates an empty cache of the shortest paths of 'graph', which registers it.
+* @param size_t budget - the most memory, in bytes, that the cached results may take
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::cache_t::cache_t(my_graph& _graph, size_t _budget)
+	: graph(&_graph), version(_graph.version()), budget(_budget), bytes(0), hits(0), misses(0), evictions(0), invalidations(0)
+{
+	graph->caches.push_back(this);
+}
+
+/// Unregisters the cache from its graph, unless the graph has detached it.
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::cache_t::~cache_t()
+{
+	if (graph != nullptr)
+		graph->caches.erase(std::find(graph->caches.begin(), graph->caches.end(), this));
+}
+
+/// Evicts the least recently used results until 'room' more bytes fit within the budget.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::cache_t::evict(size_t room)
+{
+	while (not entries.empty() and bytes + room > budget)
+	{
+		bytes -= entries.back().bytes;
+		places.erase(entries.back().key);
+		entries.pop_back();
+		++evictions;
+	}
+}
+
+/** Returns the cached result of 'algorithm' for 'source', or computes it by calling 'compute' and caches it,
+* provided it fits within the budget at all.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph, or the cache was detached from it
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class compute_t>
+std::shared_ptr<const typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t>
+my_graph<key_t, data_t, weight_t, policy_t>::cache_t::lookup(algorithm_t algorithm, key_t source, compute_t compute)
+{
+	if (graph == nullptr)
+		throw error_t(problem_t::out_of_range);
+	if (version != graph->version())
+	{
+		invalidations += entries.size();
+		clear();
+		version = graph->version();
+	}
+	uint64_t key = static_cast<uint64_t>(algorithm) << 32 | graph->index->id(source);
+	auto place = places.find(key);
+	if (place != places.end())
+	{
+		++hits;
+		entries.splice(entries.begin(), entries, place->second);
+		return place->second->result;
+	}
+	++misses;
+	auto result = std::make_shared<const OneToAll_t>(compute());
+	size_t size = sizeof(OneToAll_t) + result->distance.capacity() * sizeof(weight_t)
+		+ (result->predecessor.capacity() + result->origin.capacity()) * sizeof(uint32_t)
+		+ result->via.capacity() * sizeof(size_t);
+	if (size > budget)
+		return result;
+	evict(size);
+	entries.push_front(entry_t{ key, result, size });
+	places.emplace(key, entries.begin());
+	bytes += size;
+	return result;
+}
+
+/** Returns the shortest paths from 'source' found by my_graph::Dijkstra(), computing them only
+* if they are not cached for the current version of the graph.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph, or the cache was detached from it
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heap_t>
+std::shared_ptr<const typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t>
+my_graph<key_t, data_t, weight_t, policy_t>::cache_t::Dijkstra(key_t source)
+{
+	return lookup(Dijkstra_algorithm, source, [&]() { return graph->template Dijkstra<heap_t>(source); });
+}
+
+/** Returns the shortest paths from 'source' found by my_graph::Bellman_Ford(), computing them only
+* if they are not cached for the current version of the graph.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph, or the cache was detached from it
+* @throw error_t(problem_t::negative_cycle) - if a cycle of negative weight is reachable from 'source'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::shared_ptr<const typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t>
+my_graph<key_t, data_t, weight_t, policy_t>::cache_t::Bellman_Ford(key_t source, size_t threads)
+{
+	return lookup(Bellman_Ford_algorithm, source, [&]() { return graph->Bellman_Ford(source, threads); });
+}
+
+/** Returns the shortest paths from 'source' found by my_graph::delta_stepping(), computing them only
+* if they are not cached for the current version of the graph.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph, or the cache was detached from it
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::shared_ptr<const typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t>
+my_graph<key_t, data_t, weight_t, policy_t>::cache_t::delta_stepping(key_t source, weight_t delta, size_t threads)
+{
+	return lookup(delta_stepping_algorithm, source, [&]() { return graph->delta_stepping(source, delta, threads); });
+}
+
+/// Sets the memory budget to 'new_budget' bytes, evicting the least recently used results that exceed it.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::cache_t::reset_budget(size_t new_budget)
+{
+	budget = new_budget;
+	evict(0);
+}
+
+/// Returns the counts of the hits, the misses, the evictions and the invalidated results, and the current contents.
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::cache_t::statistics_t my_graph<key_t, data_t, weight_t, policy_t>::cache_t::statistics()
+{
+	return statistics_t{ hits, misses, evictions, invalidations, entries.size(), bytes };
+}
+
+/// Drops all the cached results; the statistics are kept.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::cache_t::clear()
+{
+	entries.clear();
+	places.clear();
+	bytes = 0;
+}
+
+/** Compiles the current state of the graph into an immutable compressed-sparse-row snapshot.
+* @param bool with_data - whether the data of the vertices should be copied into the snapshot
+* @return the snapshot of the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t my_graph<key_t, data_t, weight_t, policy_t>::freeze(bool with_data)
+{
+	auto buffers = std::make_shared<typename snapshot_t::buffers_t>();
+	if (with_data)
+	{
+		buffers->data.reserve(vertices.size());
+		for (auto i = vertices.begin(); i != vertices.end(); ++i)
+			buffers->data.push_back(i->data);
+	}
+	buffers->offsets.reserve(vertices.size() + 1);
+	buffers->heads.reserve(graph_size);
+	buffers->weights.reserve(graph_size);
+	buffers->ordinals.reserve(graph_size);
+	for (auto i = vertices.begin(); i != vertices.end(); ++i)
+	{
+		for (auto o = i->outedges.begin(); o != i->outedges.end(); ++o)
+		{
+			buffers->heads.push_back(o->head);
+			buffers->weights.push_back(o->weight);
+			buffers->ordinals.push_back(o->ordinal);
+		}
+		buffers->offsets.push_back(buffers->heads.size());
+	}
+	return snapshot_t(index, buffers);
+}
+
+/** Returns the snapshot without the data that the searches run on, compiled again only if the graph has
+* changed since the last one; the copy returned stays valid even if the graph changes meanwhile.
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t my_graph<key_t, data_t, weight_t, policy_t>::compiled()
+{
+	if (not image or image_version != graph_version)
+	{
+		// The arrays of the old snapshot are released before the new ones are allocated.
+		image.reset();
+		image = freeze(false);
+		image_version = graph_version;
+	}
+	return *image;
+}
+
+/** Writes the current state of the graph to a binary file; see snapshot_t::save_binary().
+* @throw error_t(problem_t::io_failure) - if the file cannot be written
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::save_binary(const std::string& path)
+{
+	freeze().save_binary(path);
+}
+
+/** Solves the problem of finding the shortest paths from vertex 'source' to all the vertices in the graph
+* by means of the Dijkstra's algorithm.
+* @param heap_t - the priority queue, instantiated with weight_t; see default_heap_t
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heap_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::Dijkstra(key_t source)
+{
+	index->id(source);
+	return compiled().template Dijkstra<heap_t>(source);
+}
+
+/** Checks whether the graph is empty.
+* @returns 'true' if the graph is empty, 'false' otherwise
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+bool my_graph<key_t, data_t, weight_t, policy_t>::empty()
+{
+	return vertices.empty();
+}
+
+/** Returns the version of the graph, which every change of the vertices, their keys, the edges or the weights
+* increases. The data of the vertices has no bearing on the paths, so changing it leaves the version as it is.
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+uint64_t my_graph<key_t, data_t, weight_t, policy_t>::version()
+{
+	return graph_version;
+}
+
+/** Solves the problem of finding the shortest paths from vertex 'source' to all the vertices in the graph
+* by means of the Bellman-Ford algorithm; see snapshot_t::Bellman_Ford().
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+* @throw error_t(problem_t::negative_cycle) - if a cycle of negative weight is reachable from 'source'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::Bellman_Ford(
+	key_t source, size_t threads)
+{
+	index->id(source);
+	return compiled().Bellman_Ford(source, threads);
+}
+
+/** Solves the problem of finding the shortest paths from vertex 'source' to all the vertices in the graph
+* by means of the delta-stepping algorithm; see snapshot_t::delta_stepping().
+* @param weight_t delta - the width of the distance buckets; if not positive, the mean weight of the edges
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::delta_stepping(
+	key_t source, weight_t delta, size_t threads)
+{
+	index->id(source);
+	return compiled().delta_stepping(source, delta, threads);
+}
+
+/** Finds the shortest path from 'source' to 'target' by means of the Dijkstra's algorithm, which stops
+* as soon as 'target' is settled. The snapshot the search runs on is compiled only on the first
+* search after a change of the graph, so that the queries between the changes pay only for the search.
+* @param heap_t - the priority queue, instantiated with weight_t; see default_heap_t
+* @return an object containing the path
+* @throw error_t(problem_t::out_of_range) - if 'source' or 'target' is absent in the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heap_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::shortest_path(
+	key_t source, key_t target)
+{
+	index->id(source);
+	index->id(target);
+	return compiled().template shortest_path<heap_t>(source, target);
+}
+
+/** Finds the shortest path from 'source' to 'target' by two searches, forward from 'source' and
+* backward from 'target'; see snapshot_t::bidirectional_path().
+* @return an object containing the path
+* @throw error_t(problem_t::out_of_range) - if 'source' or 'target' is absent in the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::bidirectional_path(
+	key_t source, key_t target)
+{
+	index->id(source);
+	index->id(target);
+	return compiled().bidirectional_path(source, target);
+}
+
+/** Finds the shortest path from 'source' to 'target' by means of the A* algorithm guided by the data
+* of the vertices, which the heuristic reads in place; see snapshot_t::A_star().
+* @param heuristic_t heuristic - callable as weight_t(const data_t& vertex, const data_t& target),
+* never overestimating the cost of the path from 'vertex' to 'target'
+* @return an object containing the path
+* @throw error_t(problem_t::out_of_range) - if 'source' or 'target' is absent in the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heuristic_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::A_star(
+	key_t source, key_t target, heuristic_t heuristic)
+{
+	uint32_t initial = index->id(source), terminal = index->id(target);
+	return compiled().A_star_ids(initial, terminal, heuristic,
+		[this](uint32_t vertex) -> const data_t& { return vertices[vertex].data; });
+}
+
+/** Solves the problem of finding the shortest paths between all the pairs of vertices in the graph
+* by means of the Floyd-Warshall algorithm.
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'hop_t' cannot index all the vertices
+* @throw error_t(problem_t::negative_cycle) - if the graph contains a cycle of negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::template AllToAll_table_t<cost_t, hop_t>
+my_graph<key_t, data_t, weight_t, policy_t>::Floyd_Warshall(size_t threads)
+{
+	return compiled().template Floyd_Warshall<cost_t, hop_t>(threads);
+}
+
+/** Solves the problem of finding the shortest paths between all the pairs of vertices in the graph
+* by means of the Johnson's algorithm, which suits sparse graphs better than Floyd-Warshall.
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'hop_t' cannot index all the vertices
+* @throw error_t(problem_t::negative_cycle) - if the graph contains a cycle of negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::template AllToAll_table_t<cost_t, hop_t>
+my_graph<key_t, data_t, weight_t, policy_t>::Johnson(size_t threads)
+{
+	return compiled().template Johnson<cost_t, hop_t>(threads);
+}
+
+/** Builds a contraction hierarchy of the current state of the graph; see snapshot_t::contract().
+* @param size_t threads - the number of the threads sharing the computation
+* @return the hierarchy, which does not follow later modifications of the graph
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t my_graph<key_t, data_t, weight_t, policy_t>::contract(size_t threads)
+{
+	return compiled().contract(threads);
+}
+
+/// Makes a snapshot that refers to the arrays of 'buffers'.
+template<class key_t, class data_t, class weight_t, class policy_t>
+my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::snapshot_t(
+	std::shared_ptr<const index_t> _index, std::shared_ptr<const buffers_t> buffers)
+	: storage(buffers), index(_index), data(buffers->data.empty() ? nullptr : buffers->data.data()),
+	offsets(buffers->offsets.data()), heads(buffers->heads.data()), weights(buffers->weights.data()),
+	ordinals(buffers->ordinals.data()), derived(std::make_shared<derived_t>()) {}
+
+/// Checks whether any edge of the snapshot has negative weight; the answer is computed once.
+template<class key_t, class data_t, class weight_t, class policy_t>
+bool my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::negative()
+{
+	std::call_once(derived->signs_once, [this]()
+	{
+		for (size_t e = 0; e < size(); ++e)
+		{
+			if (weights[e] < weight_t())
+				derived->negative = true;
+			if (derived->heaviest < weights[e])
+				derived->heaviest = weights[e];
+		}
+	});
+	return derived->negative;
+}
+
+/// Returns the greatest weight of an edge, or weight_t() if there are no edges; found together with the signs.
+template<class key_t, class data_t, class weight_t, class policy_t>
+weight_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::heaviest()
+{
+	negative();
+	return derived->heaviest;
+}
+
+/// Returns the inedges of the vertices, built on first use by a counting sort of the edges.
+template<class key_t, class data_t, class weight_t, class policy_t>
+const typename my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::derived_t&
+my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::reverse()
+{
+	std::call_once(derived->reverse_once, [this]()
+	{
+		derived_t& reversed = *derived;
+		reversed.offsets.assign(order() + 1, 0);
+		for (size_t e = 0; e < size(); ++e)
+			++reversed.offsets[heads[e] + 1];
+		for (size_t v = 0; v < order(); ++v)
+			reversed.offsets[v + 1] += reversed.offsets[v];
+		reversed.tails.resize(size());
+		reversed.positions.resize(size());
+		std::vector<size_t> fill(reversed.offsets.begin(), reversed.offsets.end() - 1);
+		for (uint32_t tail = 0; tail < order(); ++tail)
+		{
+			for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+			{
+				size_t r = fill[heads[e]]++;
+				reversed.tails[r] = tail;
+				reversed.positions[r] = e;
+			}
+		}
+	});
+	return *derived;
+}
+
+/// Returns the number of the vertices in the snapshot.
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::order()
+{
+	return index->keys.size();
+}
+
+/// Returns the number of the edges in the snapshot.
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::size()
+{
+	return offsets[order()];
+}
+
+/** Writes the snapshot to a binary file that snapshot_t::open_mapped() can map back into memory.
+* The file holds the CSR arrays in the native layout of the platform, followed by the keys; the data
+* of the vertices is stored byte by byte if it is trivially copyable, serialised if it is a string,
+* and omitted otherwise.
+* @throw error_t(problem_t::io_failure) - if the file cannot be written
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::save_binary(const std::string& path)
+{
+	static_assert(serialisable_t<key_t>::value, "the keys must be trivially copyable or strings");
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (not file)
+		throw error_t(problem_t::io_failure);
+	header_t header = header_t();
+	std::memcpy(header.signature, "DWGRAPH", 8);
+	header.version = format_version;
+	header.endianness = 0x01020304;
+	header.index_width = sizeof(size_t);
+	header.weight_width = sizeof(weight_t);
+	header.key_width = sizeof(key_t);
+	header.data_width = sizeof(data_t);
+	header.order = order();
+	header.size = size();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	auto section = [&file](const void* items, size_t bytes)
+	{
+		while (static_cast<std::streamoff>(file.tellp()) % 64 != 0)
+			file.put('\0');
+		uint64_t at = static_cast<std::streamoff>(file.tellp());
+		file.write(static_cast<const char*>(items), bytes);
+		return at;
+	};
+	header.offsets_at = section(offsets, (order() + 1) * sizeof(size_t));
+	header.heads_at = section(heads, size() * sizeof(uint32_t));
+	header.weights_at = section(weights, size() * sizeof(weight_t));
+	header.ordinals_at = section(ordinals, size() * sizeof(size_t));
+	header.data_format = no_data;
+	if (data != nullptr)
+	{
+		if constexpr (std::is_trivially_copyable_v<data_t>)
+		{
+			header.data_format = raw_data;
+			header.data_at = section(data, order() * sizeof(data_t));
+		}
+		else if constexpr (serialisable_t<data_t>::value)
+		{
+			header.data_format = serialised_data;
+			header.data_at = section(nullptr, 0);
+			for (size_t v = 0; v < order(); ++v)
+				write_binary(file, data[v]);
+		}
+	}
+	header.keys_at = section(nullptr, 0);
+	for (size_t v = 0; v < order(); ++v)
+		write_binary(file, index->keys[v]);
+	file.seekp(0);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	if (not file)
+		throw error_t(problem_t::io_failure);
+}
+
+/** Maps a file written by save_binary() into memory. The CSR arrays and the raw data are used in place,
+* without copying, once the offsets and the heads are checked to stay in range; the keys are read, to
+* rebuild the bijection with the indices. The mapping is shared by the copies of the snapshot and released
+* with the last of them.
+* @return the snapshot stored in the file
+* @throw error_t(problem_t::io_failure) - if the file cannot be opened or mapped
+* @throw error_t(problem_t::invalid_value) - if the file was not written by save_binary() for this
+* instantiation of the template on a platform of the same layout, or is truncated or corrupt
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::open_mapped(const std::string& path)
+{
+	static_assert(serialisable_t<key_t>::value, "the keys must be trivially copyable or strings");
+	auto mapped = std::make_shared<mapped_t>(path);
+	const char* base = mapped->file.begin();
+	const char* end = base + mapped->file.size();
+	header_t header;
+	if (mapped->file.size() < sizeof(header))
+		throw error_t(problem_t::invalid_value);
+	std::memcpy(&header, base, sizeof(header));
+	if (std::memcmp(header.signature, "DWGRAPH", 8) != 0 or header.version != format_version
+		or header.endianness != 0x01020304 or header.index_width != sizeof(size_t)
+		or header.weight_width != sizeof(weight_t) or header.key_width != sizeof(key_t)
+		or header.data_width != sizeof(data_t) or header.order >= no_vertex)
+		throw error_t(problem_t::invalid_value);
+	auto section = [base, end](uint64_t at, uint64_t count, size_t width)
+	{
+		uint64_t length = static_cast<uint64_t>(end - base);
+		if (at > length or count > (length - at) / width)
+			throw error_t(problem_t::invalid_value);
+		return base + at;
+	};
+	snapshot_t image;
+	image.offsets = reinterpret_cast<const size_t*>(section(header.offsets_at, header.order + 1, sizeof(size_t)));
+	image.heads = reinterpret_cast<const uint32_t*>(section(header.heads_at, header.size, sizeof(uint32_t)));
+	image.weights = reinterpret_cast<const weight_t*>(section(header.weights_at, header.size, sizeof(weight_t)));
+	image.ordinals = reinterpret_cast<const size_t*>(section(header.ordinals_at, header.size, sizeof(size_t)));
+	// The searches index the arrays by the offsets and the heads without checks, so they are validated once here.
+	bool valid = image.offsets[0] == 0 and image.offsets[header.order] == header.size;
+	for (size_t v = 0; valid and v < header.order; ++v)
+		valid = image.offsets[v] <= image.offsets[v + 1];
+	for (size_t e = 0; valid and e < header.size; ++e)
+		valid = image.heads[e] < header.order;
+	if (not valid)
+		throw error_t(problem_t::invalid_value);
+	image.data = nullptr;
+	if (header.data_format == raw_data)
+	{
+		if constexpr (std::is_trivially_copyable_v<data_t>)
+			image.data = reinterpret_cast<const data_t*>(section(header.data_at, header.order, sizeof(data_t)));
+		else
+			throw error_t(problem_t::invalid_value);
+	}
+	else if (header.data_format == serialised_data)
+	{
+		if constexpr (serialisable_t<data_t>::value and not std::is_trivially_copyable_v<data_t>)
+		{
+			const char* cursor = section(header.data_at, 0, 1);
+			mapped->data.resize(static_cast<size_t>(header.order));
+			for (size_t v = 0; v < header.order; ++v)
+				read_binary(cursor, end, mapped->data[v]);
+			image.data = mapped->data.data();
+		}
+		else
+			throw error_t(problem_t::invalid_value);
+	}
+	auto keys = std::make_shared<index_t>();
+	keys->keys.resize(static_cast<size_t>(header.order));
+	keys->ids.reserve(static_cast<size_t>(header.order));
+	const char* cursor = section(header.keys_at, 0, 1);
+	for (uint32_t v = 0; v < header.order; ++v)
+	{
+		read_binary(cursor, end, keys->keys[v]);
+		keys->ids.emplace(keys->keys[v], v);
+	}
+	image.index = keys;
+	image.storage = mapped;
+	return image;
+}
+
+/** Visits the vertices in the breadth first order, beginning with vertex 'source'. When no more vertices
+* are reachable, the search is resumed from the unvisited vertex of the lowest index.
+* @param events_t events - the search_events_t receiving the indices of the vertices and the positions of the edges;
+* the search stops as soon as any event returns false
+* @param uint32_t source - the index of the initial vertex
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class events_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::breadth_first_ids(events_t& events, uint32_t source)
+{
+	std::vector<bool> visited(order(), false);
+	std::vector<uint32_t> vertices;
+	vertices.reserve(order());
+	size_t front = 0;
+	uint32_t cursor = 0;
+	for (uint32_t root = source; root != no_vertex; )
+	{
+		visited[root] = true;
+		if (not events.discover(root))
+			return;
+		vertices.push_back(root);
+		while (front < vertices.size())
+		{
+			uint32_t vertex = vertices[front++];
+			for (size_t e = offsets[vertex]; e < offsets[vertex + 1]; ++e)
+			{
+				if (not events.examine(e, vertex))
+					return;
+				if (not visited[heads[e]])
+				{
+					visited[heads[e]] = true;
+					if (not events.tree(e, vertex) or not events.discover(heads[e]))
+						return;
+					vertices.push_back(heads[e]);
+				}
+			}
+			if (not events.finish(vertex))
+				return;
+		}
+		while (cursor < order() and visited[cursor])
+			++cursor;
+		root = cursor < order() ? cursor : no_vertex;
+	}
+}
+
+/** Visits the vertices in the depth first order, beginning with vertex 'source'. When no more vertices
+* are reachable, the search is resumed from the unvisited vertex of the lowest index.
+* @param events_t events - the search_events_t receiving the indices of the vertices and the positions of the edges;
+* the search stops as soon as any event returns false
+* @param uint32_t source - the index of the initial vertex
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class events_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::depth_first_ids(events_t& events, uint32_t source)
+{
+	std::vector<bool> visited(order(), false);
+	std::vector<std::pair<uint32_t, size_t>> last_place;
+	uint32_t cursor = 0;
+	for (uint32_t root = source; root != no_vertex; )
+	{
+		visited[root] = true;
+		if (not events.discover(root))
+			return;
+		last_place.emplace_back(root, offsets[root]);
+		while (not last_place.empty())
+		{
+			uint32_t vertex = last_place.back().first;
+			size_t e = last_place.back().second;
+			if (e == offsets[vertex + 1])
+			{
+				last_place.pop_back();
+				if (not events.finish(vertex))
+					return;
+				continue;
+			}
+			++last_place.back().second;
+			if (not events.examine(e, vertex))
+				return;
+			if (not visited[heads[e]])
+			{
+				visited[heads[e]] = true;
+				if (not events.tree(e, vertex) or not events.discover(heads[e]))
+					return;
+				last_place.emplace_back(heads[e], offsets[heads[e]]);
+			}
+		}
+		while (cursor < order() and visited[cursor])
+			++cursor;
+		root = cursor < order() ? cursor : no_vertex;
+	}
+}
+
+/** Performs breadth first search algorithm on the snapshot, beginning with vertex 'source'; see
+* my_graph::breadth_first_search(). The visitor receives the data as 'const data_t&', default-constructed
+* if the snapshot was compiled without the data.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the snapshot
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class visitor_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::breadth_first_search(visitor_t&& visitor, key_t source)
+{
+	if (order() == 0)
+		return;
+	const data_t none = data_t();
+	auto found = events(visitor, [this, &none](uint32_t vertex) -> const data_t& { return data == nullptr ? none : data[vertex]; });
+	breadth_first_ids(found, index->id(source));
+}
+
+/** Performs depth first search algorithm on the snapshot, beginning with vertex 'source'; see
+* my_graph::breadth_first_search(). The visitor receives the data as 'const data_t&', default-constructed
+* if the snapshot was compiled without the data.
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the snapshot
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class visitor_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::depth_first_search(visitor_t&& visitor, key_t source)
+{
+	if (order() == 0)
+		return;
+	const data_t none = data_t();
+	auto found = events(visitor, [this, &none](uint32_t vertex) -> const data_t& { return data == nullptr ? none : data[vertex]; });
+	depth_first_ids(found, index->id(source));
+}
+
+/** Builds the breadth first tree of the vertices reachable from 'source' in the snapshot, one level at a time.
+* A level is expanded either top-down, along the outedges of the frontier, or bottom-up, by looking among
+* the inedges of every unvisited vertex for a tail in the frontier, whichever should examine fewer edges:
+* the search turns bottom-up when the outedges of the frontier exceed 1/14 of the outedges of the unvisited
+* vertices, and top-down again when the frontier holds less than 1/24 of the vertices. The visited vertices
+* and the frontier of a bottom-up step are kept in bitmaps. The threads own the vertices by the 64-bit words
+* of the bitmaps, so no word is written by two threads and the tree does not depend on their timing.
+* @param size_t threads - the number of threads expanding each level
+* @return an object containing the tree
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the snapshot
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::BreadthFirst_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::breadth_first_tree(
+	key_t source, size_t threads)
+{
+	static constexpr size_t alpha = 14, beta = 24;
+	uint32_t initial = index->id(source);
+	threads = std::max<size_t>(threads, 1);
+	const size_t n = order(), words = (n + 63) / 64;
+	std::vector<uint32_t> levels(n, no_vertex), parents(n, no_vertex);
+	std::vector<uint64_t> visited(words, 0), members(words, 0);
+	auto marked = [](const std::vector<uint64_t>& bitmap, uint32_t v) { return (bitmap[v / 64] >> (v % 64) & 1) != 0; };
+	auto mark = [](std::vector<uint64_t>& bitmap, uint32_t v) { bitmap[v / 64] |= uint64_t(1) << (v % 64); };
+	auto degree = [this](uint32_t v) { return offsets[v + 1] - offsets[v]; };
+	// The vertices added to the tree by each thread during the current level.
+	std::vector<std::vector<uint32_t>> found(threads);
+	// The edges (head, tail) that reached unvisited vertices, sorted by the thread owning the head.
+	std::vector<std::vector<std::vector<std::pair<uint32_t, uint32_t>>>> claims(threads,
+		std::vector<std::vector<std::pair<uint32_t, uint32_t>>>(threads));
+	uint32_t level = 0;
+	auto claim = [&](uint32_t head, uint32_t tail, size_t owner)
+	{
+		if (marked(visited, head))
+			return false;
+		mark(visited, head);
+		levels[head] = level;
+		parents[head] = tail;
+		found[owner].push_back(head);
+		return true;
+	};
+	std::vector<uint32_t> frontier(1, initial);
+	mark(visited, initial);
+	levels[initial] = 0;
+	size_t unexplored = size() - degree(initial);
+	bool bottom_up = false;
+	while (not frontier.empty())
+	{
+		++level;
+		size_t scouted = 0;
+		for (auto v = frontier.begin(); v != frontier.end(); ++v)
+			scouted += degree(*v);
+		bottom_up = bottom_up ? frontier.size() >= n / beta : scouted > unexplored / alpha;
+		if (bottom_up)
+		{
+			const derived_t& reversed = reverse();
+			std::fill(members.begin(), members.end(), 0);
+			for (auto v = frontier.begin(); v != frontier.end(); ++v)
+				mark(members, *v);
+			parallel_for(threads, threads, [&](size_t t)
+			{
+				for (size_t w = words * t / threads; w < words * (t + 1) / threads; ++w)
+				{
+					if (visited[w] == ~uint64_t(0))
+						continue;
+					for (uint32_t v = uint32_t(w * 64); v < std::min(n, w * 64 + 64); ++v)
+					{
+						if (marked(visited, v))
+							continue;
+						for (size_t r = reversed.offsets[v]; r < reversed.offsets[v + 1]; ++r)
+						{
+							if (marked(members, reversed.tails[r]) and claim(v, reversed.tails[r], t))
+								break;
+						}
+					}
+				}
+			});
+		}
+		else
+		{
+			parallel_for(threads, threads, [&](size_t t)
+			{
+				for (size_t i = frontier.size() * t / threads; i < frontier.size() * (t + 1) / threads; ++i)
+				{
+					uint32_t tail = frontier[i];
+					for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+					{
+						if (threads == 1)
+							claim(heads[e], tail, 0);
+						else if (not marked(visited, heads[e]))
+							claims[t][heads[e] / 64 % threads].emplace_back(heads[e], tail);
+					}
+				}
+			});
+			parallel_for(threads, threads, [&](size_t owner)
+			{
+				for (size_t t = 0; t < threads; ++t)
+				{
+					for (auto c = claims[t][owner].begin(); c != claims[t][owner].end(); ++c)
+						claim(c->first, c->second, owner);
+					claims[t][owner].clear();
+				}
+			});
+		}
+		frontier.clear();
+		for (size_t t = 0; t < threads; ++t)
+		{
+			frontier.insert(frontier.end(), found[t].begin(), found[t].end());
+			found[t].clear();
+		}
+		for (auto v = frontier.begin(); v != frontier.end(); ++v)
+			unexplored -= degree(*v);
+	}
+	BreadthFirst_t results;
+	results.index = index;
+	results.initial = initial;
+	results.levels = std::move(levels);
+	results.parents = std::move(parents);
+	return results;
+}
+
+/** Solves the single-source shortest paths problem on the snapshot by means of the Dijkstra's algorithm.
+* Only the reached vertices enter the priority queue, and their keys are decreased in place.
+* @param heap_t - the priority queue, instantiated with weight_t; see default_heap_t
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the snapshot
+* @throw error_t(problem_t::negative_weight) - if any edge of the snapshot has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heap_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::Dijkstra(key_t source)
+{
+	if constexpr (std::is_same_v<heap_t, automatic_heap_t<weight_t>>)
+	{
+		if (static_cast<uint64_t>(heaviest()) <= heap_t::Dial_limit)
+			return Dijkstra<Dial_heap_t<weight_t>>(source);
+		return Dijkstra<radix_heap_t<weight_t>>(source);
+	}
+	else
+	{
+		uint32_t initial = index->id(source);
+		if (negative())
+			throw error_t(problem_t::negative_weight);
+		std::vector<weight_t> distance(order(), infinity);
+		std::vector<uint32_t> predecessor(order(), no_vertex);
+		std::vector<size_t> via(order(), 0);
+		heap_t heap(order());
+		distance[initial] = weight_t();
+		heap.push(initial, distance[initial]);
+		while (not heap.empty())
+		{
+			uint32_t closest = heap.pop();
+			for (size_t e = offsets[closest]; e < offsets[closest + 1]; ++e)
+			{
+				uint32_t head = heads[e];
+				weight_t length = distance[closest] + weights[e];
+				if (length < distance[head])
+				{
+					if (heap.contains(head))
+						heap.decrease(head, length);
+					else
+						heap.push(head, length);
+					distance[head] = length;
+					predecessor[head] = closest;
+					via[head] = ordinals[e];
+				}
+			}
+		}
+		return solution(initial, distance, predecessor, via);
+	}
+}
+
+/** Solves the single-source shortest paths problem on the snapshot by means of the Bellman-Ford algorithm.
+* The computation proceeds in rounds, each relaxing only the outedges of the vertices whose distance
+* changed in the previous round, shared among the threads as in delta_stepping(). Without a cycle of
+* negative weight every distance is final after order() - 1 rounds, so a change in round order()
+* proves such a cycle.
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the snapshot
+* @throw error_t(problem_t::negative_cycle) - if a cycle of negative weight is reachable from 'source'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::Bellman_Ford(
+	key_t source, size_t threads)
+{
+	uint32_t initial = index->id(source);
+	threads = std::max<size_t>(threads, 1);
+	std::vector<weight_t> distance(order(), infinity);
+	std::vector<uint32_t> predecessor(order(), no_vertex);
+	std::vector<size_t> via(order(), 0);
+	std::vector<std::vector<uint32_t>> improved(threads);
+	std::vector<uint32_t> frontier(1, initial);
+	std::vector<char> queued(order(), 0);
+	distance[initial] = weight_t();
+	for (size_t round = 1; not frontier.empty(); ++round)
+	{
+		if (round > order())
+			throw error_t(problem_t::negative_cycle);
+		relax(frontier, [](size_t) { return true; }, threads, distance, predecessor, via, improved);
+		frontier.clear();
+		for (auto owner = improved.begin(); owner != improved.end(); ++owner)
+		{
+			for (auto v = owner->begin(); v != owner->end(); ++v)
+			{
+				if (not queued[*v])
+				{
+					queued[*v] = 1;
+					frontier.push_back(*v);
+				}
+			}
+			owner->clear();
+		}
+		for (auto v = frontier.begin(); v != frontier.end(); ++v)
+			queued[*v] = 0;
+	}
+	return solution(initial, distance, predecessor, via);
+}
+
+/** Solves the shortest paths problem from the nearest of several sources by means of the Dijkstra's algorithm
+* started from all of them at once; the source nearest to each vertex is returned by OneToAll_t::nearest_source().
+* @param heap_t - the priority queue, instantiated with weight_t; see default_heap_t
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if any of 'sources' is absent in the snapshot
+* @throw error_t(problem_t::negative_weight) - if any edge of the snapshot has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heap_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::nearest_source_paths(
+	const std::vector<key_t>& sources)
+{
+	if constexpr (std::is_same_v<heap_t, automatic_heap_t<weight_t>>)
+	{
+		if (static_cast<uint64_t>(heaviest()) <= heap_t::Dial_limit)
+			return nearest_source_paths<Dial_heap_t<weight_t>>(sources);
+		return nearest_source_paths<radix_heap_t<weight_t>>(sources);
+	}
+	else
+	{
+		std::vector<uint32_t> initials;
+		for (auto s = sources.begin(); s != sources.end(); ++s)
+			initials.push_back(index->id(*s));
+		if (negative())
+			throw error_t(problem_t::negative_weight);
+		std::vector<weight_t> distance(order(), infinity);
+		std::vector<uint32_t> predecessor(order(), no_vertex);
+		std::vector<size_t> via(order(), 0);
+		std::vector<uint32_t> origin(order(), no_vertex);
+		heap_t heap(order());
+		for (auto s = initials.begin(); s != initials.end(); ++s)
+		{
+			if (origin[*s] != no_vertex)
+				continue;
+			distance[*s] = weight_t();
+			origin[*s] = *s;
+			heap.push(*s, distance[*s]);
+		}
+		while (not heap.empty())
+		{
+			uint32_t closest = heap.pop();
+			for (size_t e = offsets[closest]; e < offsets[closest + 1]; ++e)
+			{
+				uint32_t head = heads[e];
+				weight_t length = distance[closest] + weights[e];
+				if (length < distance[head])
+				{
+					if (heap.contains(head))
+						heap.decrease(head, length);
+					else
+						heap.push(head, length);
+					distance[head] = length;
+					predecessor[head] = closest;
+					via[head] = ordinals[e];
+					origin[head] = origin[closest];
+				}
+			}
+		}
+		OneToAll_t results = solution(no_vertex, distance, predecessor, via);
+		results.origin = std::move(origin);
+		return results;
+	}
+}
+
+/** Solves the single-source shortest paths problem on the snapshot for several sources at once. The sources
+* are taken in batches of 'lanes', and every vertex keeps the distances from all the sources of a batch
+* side by side, so one scan of the outedges of a vertex relaxes them for the whole batch in a branch-free
+* loop that the compiler can vectorise. Without edges of negative weight the vertices are scanned in the
+* order of their least improved distance, as in Dijkstra(); otherwise in rounds, as in Bellman_Ford().
+* A vertex is rescanned whenever any of its distances improves, so the batches pay off when their sources
+* lie close together; sources far apart on a graph of long paths are searched about as fast by Dijkstra().
+* The batches are shared among the threads.
+* @param size_t threads - the number of the threads sharing the batches
+* @return an object containing the solutions to the problem
+* @throw error_t(problem_t::out_of_range) - if any of 'sources' is absent in the snapshot
+* @throw error_t(problem_t::negative_cycle) - if a cycle of negative weight is reachable from any of 'sources'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::ManyToAll_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::multi_source_shortest_paths(
+	const std::vector<key_t>& sources, size_t threads)
+{
+	ManyToAll_t results;
+	results.index = index;
+	for (auto s = sources.begin(); s != sources.end(); ++s)
+	{
+		results.sources.push_back(index->id(*s));
+		results.rows.emplace(results.sources.back(), results.sources.size() - 1);
+	}
+	const size_t n = order(), k = sources.size();
+	results.distance.assign(k * n, infinity);
+	results.predecessor.assign(k * n, no_vertex);
+	results.via.assign(k * n, 0);
+	const bool signed_weights = negative();
+	parallel_for((k + lanes - 1) / lanes, threads, [&](size_t batch)
+	{
+		const size_t first = batch * lanes, width = std::min(lanes, k - first);
+		// The lanes of vertex 'v' occupy the positions [v * lanes, (v + 1) * lanes); 'position' holds the
+		// positions of the edges through which the distances were last improved.
+		std::vector<weight_t> distance(n * lanes, infinity);
+		std::vector<uint32_t> predecessor(n * lanes, no_vertex);
+		std::vector<size_t> position(n * lanes, 0);
+		// Relaxes edge 'e' from 'tail' in all the lanes; returns the least improved distance, or infinity.
+		auto relax_lanes = [&](uint32_t tail, size_t e)
+		{
+			const size_t from = tail * lanes, to = heads[e] * lanes;
+			// Most relaxations improve no lane, so they are first tested without writing.
+			bool improved = false;
+			for (size_t l = 0; l < lanes; ++l)
+				improved |= extend_cost(distance[from + l], weights[e]) < distance[to + l];
+			weight_t least = infinity;
+			if (not improved)
+				return least;
+			for (size_t l = 0; l < lanes; ++l)
+			{
+				weight_t length = extend_cost(distance[from + l], weights[e]);
+				bool better = length < distance[to + l];
+				distance[to + l] = better ? length : distance[to + l];
+				predecessor[to + l] = better ? tail : predecessor[to + l];
+				position[to + l] = better ? e : position[to + l];
+				least = better and length < least ? length : least;
+			}
+			return least;
+		};
+		std::vector<uint32_t> frontier;
+		for (size_t l = 0; l < width; ++l)
+		{
+			uint32_t initial = results.sources[first + l];
+			distance[initial * lanes + l] = weight_t();
+			frontier.push_back(initial);
+		}
+		if (not signed_weights)
+		{
+			// A vertex is scanned in the order of the least of its distances improved since its last scan.
+			d_ary_heap_t<weight_t> heap(n);
+			std::vector<weight_t> priority(n, infinity);
+			for (auto v = frontier.begin(); v != frontier.end(); ++v)
+			{
+				if (not heap.contains(*v))
+					heap.push(*v, priority[*v] = weight_t());
+			}
+			while (not heap.empty())
+			{
+				uint32_t tail = heap.pop();
+				priority[tail] = infinity;
+				for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+				{
+					weight_t least = relax_lanes(tail, e);
+					if (not (least < priority[heads[e]]))
+						continue;
+					if (heap.contains(heads[e]))
+						heap.decrease(heads[e], least);
+					else
+						heap.push(heads[e], least);
+					priority[heads[e]] = least;
+				}
+			}
+		}
+		else
+		{
+			std::vector<uint32_t> next;
+			std::vector<char> queued(n, 0);
+			std::sort(frontier.begin(), frontier.end());
+			frontier.erase(std::unique(frontier.begin(), frontier.end()), frontier.end());
+			for (size_t round = 1; not frontier.empty(); ++round)
+			{
+				if (round > n)
+					throw error_t(problem_t::negative_cycle);
+				for (auto v = frontier.begin(); v != frontier.end(); ++v)
+					queued[*v] = 0;
+				for (auto v = frontier.begin(); v != frontier.end(); ++v)
+				{
+					for (size_t e = offsets[*v]; e < offsets[*v + 1]; ++e)
+					{
+						if (relax_lanes(*v, e) < infinity and not queued[heads[e]])
+						{
+							queued[heads[e]] = 1;
+							next.push_back(heads[e]);
+						}
+					}
+				}
+				frontier.swap(next);
+				next.clear();
+			}
+		}
+		for (size_t l = 0; l < width; ++l)
+		{
+			const size_t row = (first + l) * n;
+			for (size_t v = 0; v < n; ++v)
+			{
+				results.distance[row + v] = distance[v * lanes + l];
+				results.predecessor[row + v] = predecessor[v * lanes + l];
+				if (predecessor[v * lanes + l] != no_vertex)
+					results.via[row + v] = ordinals[position[v * lanes + l]];
+			}
+		}
+	});
+	return results;
+}
+
+/** Solves the single-source shortest paths problem on the snapshot by means of the delta-stepping algorithm.
+* The reached vertices are kept in buckets of distances 'delta' wide. The lowest bucket is emptied
+* by relaxing the light edges (not heavier than 'delta') of its vertices, which may refill it, and then
+* the heavy edges of all the vertices it held. The relaxations are shared among the threads by relax(),
+* so the result depends only on the number of the threads.
+* @param weight_t delta - the width of the buckets; if not positive, the mean weight of the edges
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the snapshot
+* @throw error_t(problem_t::negative_weight) - if any edge of the snapshot has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::delta_stepping(
+	key_t source, weight_t delta, size_t threads)
+{
+	uint32_t initial = index->id(source);
+	if (negative())
+		throw error_t(problem_t::negative_weight);
+	threads = std::max<size_t>(threads, 1);
+	if (not (delta > weight_t()))
+	{
+		weight_t total = weight_t();
+		for (size_t e = 0; e < size(); ++e)
+			total += weights[e];
+		delta = size() == 0 ? weight_t() : total / static_cast<weight_t>(size());
+		if (not (delta > weight_t()))
+			delta = weight_t(1);
+	}
+	std::vector<weight_t> distance(order(), infinity);
+	std::vector<uint32_t> predecessor(order(), no_vertex);
+	std::vector<size_t> via(order(), 0);
+	std::vector<std::vector<uint32_t>> improved(threads);
+	std::map<size_t, std::vector<uint32_t>> buckets;
+	auto bucket_of = [&delta](weight_t length) { return static_cast<size_t>(length / delta); };
+	auto relax_edges = [&](const std::vector<uint32_t>& frontier, bool light)
+	{
+		relax(frontier, [&](size_t e) { return (weights[e] <= delta) == light; }, threads, distance, predecessor, via, improved);
+		for (auto owner = improved.begin(); owner != improved.end(); ++owner)
+		{
+			for (auto v = owner->begin(); v != owner->end(); ++v)
+				buckets[bucket_of(distance[*v])].push_back(*v);
+			owner->clear();
+		}
+	};
+	distance[initial] = weight_t();
+	buckets[0].push_back(initial);
+	// The vertices taken from the current bucket: 1 in the current pass, 2 in any pass over the bucket.
+	std::vector<char> taken(order(), 0);
+	std::vector<uint32_t> frontier, emptied;
+	while (not buckets.empty())
+	{
+		size_t current = buckets.begin()->first;
+		for (auto bucket = buckets.begin(); bucket != buckets.end() and bucket->first == current; bucket = buckets.begin())
+		{
+			frontier.clear();
+			for (auto v = bucket->second.begin(); v != bucket->second.end(); ++v)
+			{
+				// The entries of the vertices that have moved to a lower bucket are stale.
+				if (bucket_of(distance[*v]) != current or taken[*v] == 1)
+					continue;
+				if (taken[*v] == 0)
+					emptied.push_back(*v);
+				taken[*v] = 1;
+				frontier.push_back(*v);
+			}
+			buckets.erase(bucket);
+			for (auto v = frontier.begin(); v != frontier.end(); ++v)
+				taken[*v] = 2;
+			relax_edges(frontier, true);
+		}
+		relax_edges(emptied, false);
+		for (auto v = emptied.begin(); v != emptied.end(); ++v)
+			taken[*v] = 0;
+		emptied.clear();
+	}
+	return solution(initial, distance, predecessor, via);
+}
+
+/** Relaxes the outedges of the vertices of 'frontier' at the positions 'e' for which 'select(e)' holds.
+* The threads first collect the proposed distances from their slices of the frontier, sorted by the
+* thread owning the head (its index modulo the number of the threads), and then every thread applies
+* the proposals for its own vertices, so no distance is written by two threads. The vertices whose
+* distance decreased are appended to 'improved[owner]', possibly more than once.
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class select_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::relax(const std::vector<uint32_t>& frontier, select_t select,
+	size_t threads, std::vector<weight_t>& distance, std::vector<uint32_t>& predecessor, std::vector<size_t>& via,
+	std::vector<std::vector<uint32_t>>& improved)
+{
+	// A proposed distance of 'head' through the edge of ordinal 'ordinal' from 'tail'.
+	struct request_t
+	{
+		uint32_t head, tail;
+		weight_t length;
+		size_t ordinal;
+	};
+	std::vector<std::vector<std::vector<request_t>>> requests(threads, std::vector<std::vector<request_t>>(threads));
+	parallel_for(threads, threads, [&](size_t t)
+	{
+		for (size_t i = frontier.size() * t / threads; i < frontier.size() * (t + 1) / threads; ++i)
+		{
+			uint32_t tail = frontier[i];
+			for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+			{
+				if (select(e))
+					requests[t][heads[e] % threads].push_back(request_t{ heads[e], tail, distance[tail] + weights[e], ordinals[e] });
+			}
+		}
+	});
+	parallel_for(threads, threads, [&](size_t owner)
+	{
+		for (size_t t = 0; t < threads; ++t)
+		{
+			for (auto r = requests[t][owner].begin(); r != requests[t][owner].end(); ++r)
+			{
+				if (r->length < distance[r->head])
+				{
+					distance[r->head] = r->length;
+					predecessor[r->head] = r->tail;
+					via[r->head] = r->ordinal;
+					improved[owner].push_back(r->head);
+				}
+			}
+		}
+	});
+}
+
+/** Finds the shortest path from 'source' to 'target' in the snapshot by means of the Dijkstra's algorithm,
+* which stops as soon as 'target' is settled.
+* @param heap_t - the priority queue, instantiated with weight_t; see default_heap_t
+* @return an object containing the path
+* @throw error_t(problem_t::out_of_range) - if 'source' or 'target' is absent in the snapshot
+* @throw error_t(problem_t::negative_weight) - if any edge of the snapshot has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heap_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::shortest_path(
+	key_t source, key_t target)
+{
+	if constexpr (std::is_same_v<heap_t, automatic_heap_t<weight_t>>)
+	{
+		if (static_cast<uint64_t>(heaviest()) <= heap_t::Dial_limit)
+			return shortest_path<Dial_heap_t<weight_t>>(source, target);
+		return shortest_path<radix_heap_t<weight_t>>(source, target);
+	}
+	else
+	{
+		uint32_t initial = index->id(source), terminal = index->id(target);
+		if (negative())
+			throw error_t(problem_t::negative_weight);
+		std::vector<weight_t> distance(order(), infinity);
+		std::vector<uint32_t> predecessor(order(), no_vertex);
+		std::vector<size_t> via(order(), 0);
+		heap_t heap(order());
+		distance[initial] = weight_t();
+		heap.push(initial, distance[initial]);
+		while (not heap.empty())
+		{
+			uint32_t closest = heap.pop();
+			if (closest == terminal)
+				break;
+			for (size_t e = offsets[closest]; e < offsets[closest + 1]; ++e)
+			{
+				uint32_t head = heads[e];
+				weight_t length = distance[closest] + weights[e];
+				if (length < distance[head])
+				{
+					if (heap.contains(head))
+						heap.decrease(head, length);
+					else
+						heap.push(head, length);
+					distance[head] = length;
+					predecessor[head] = closest;
+					via[head] = ordinals[e];
+				}
+			}
+		}
+		return route(initial, terminal, distance[terminal], predecessor, via);
+	}
+}
+
+/** Finds the shortest path from 'source' to 'target' in the snapshot by two searches of the Dijkstra's
+* algorithm, forward from 'source' and backward from 'target' over the inedges, which advance in turn
+* until no path through the unsettled vertices can be shorter than the best one found.
+* The inedges are built on the first call and shared by the copies of the snapshot.
+* @return an object containing the path
+* @throw error_t(problem_t::out_of_range) - if 'source' or 'target' is absent in the snapshot
+* @throw error_t(problem_t::negative_weight) - if any edge of the snapshot has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::bidirectional_path(
+	key_t source, key_t target)
+{
+	uint32_t initial = index->id(source), terminal = index->id(target);
+	if (negative())
+		throw error_t(problem_t::negative_weight);
+	const derived_t& reversed = reverse();
+	std::vector<weight_t> forward(order(), infinity), backward(order(), infinity);
+	std::vector<uint32_t> predecessor(order(), no_vertex), successor(order(), no_vertex);
+	std::vector<size_t> via(order(), 0), via_back(order(), 0);
+	d_ary_heap_t<weight_t> forward_heap(order()), backward_heap(order());
+	forward[initial] = weight_t();
+	backward[terminal] = weight_t();
+	forward_heap.push(initial, forward[initial]);
+	backward_heap.push(terminal, backward[terminal]);
+	weight_t best = initial == terminal ? weight_t() : infinity;
+	uint32_t meeting = initial == terminal ? initial : no_vertex;
+	while (not forward_heap.empty() and not backward_heap.empty())
+	{
+		weight_t ahead = forward[forward_heap.top()], behind = backward[backward_heap.top()];
+		if (not (ahead + behind < best))
+			break;
+		if (ahead <= behind)
+		{
+			uint32_t closest = forward_heap.pop();
+			for (size_t e = offsets[closest]; e < offsets[closest + 1]; ++e)
+			{
+				uint32_t head = heads[e];
+				weight_t length = forward[closest] + weights[e];
+				if (length < forward[head])
+				{
+					if (forward_heap.contains(head))
+						forward_heap.decrease(head, length);
+					else
+						forward_heap.push(head, length);
+					forward[head] = length;
+					predecessor[head] = closest;
+					via[head] = ordinals[e];
+					if (extend_cost(backward[head], length) < best)
+					{
+						best = length + backward[head];
+						meeting = head;
+					}
+				}
+			}
+		}
+		else
+		{
+			uint32_t closest = backward_heap.pop();
+			for (size_t r = reversed.offsets[closest]; r < reversed.offsets[closest + 1]; ++r)
+			{
+				uint32_t tail = reversed.tails[r];
+				size_t e = reversed.positions[r];
+				weight_t length = backward[closest] + weights[e];
+				if (length < backward[tail])
+				{
+					if (backward_heap.contains(tail))
+						backward_heap.decrease(tail, length);
+					else
+						backward_heap.push(tail, length);
+					backward[tail] = length;
+					successor[tail] = closest;
+					via_back[tail] = ordinals[e];
+					if (extend_cost(forward[tail], length) < best)
+					{
+						best = forward[tail] + length;
+						meeting = tail;
+					}
+				}
+			}
+		}
+	}
+	if (meeting == no_vertex)
+		return route(initial, terminal, infinity, predecessor, via);
+	OneToOne_t results = route(initial, meeting, best, predecessor, via);
+	for (uint32_t vertex = meeting; vertex != terminal; vertex = successor[vertex])
 	{
-		std::cout << "(" << i->first << ")\t{" << i->second.data << "}\t";
-		if (i->second.outedges.empty())
-			std::cout << "<none>";
-		else
-			for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
-				std::cout << "[" << o->ordinal << "|" << o->head << ":" << o->weight << "] ";
-		std::cout << std::endl;
+		results.vertices.push_back(successor[vertex]);
+		results.edges.push_back(via_back[vertex]);
 	}
+	return results;
 }
 
-/** Inserts vertex 'key', provided such key is not yet present in the graph,
-* and assigns it with 'data', that is equal to data_t() by default.
-* @param key_t key - the key that should be inserted
-* @param data_t data - the data that should be assigned to the vertex
+/** Finds the shortest path from 'source' to 'target' in the snapshot by means of the A* algorithm,
+* which settles the vertices in the order of their distance from 'source' plus the estimate of their
+* distance to 'target'. With no data in the snapshot, the estimates receive default values of data_t.
+* @param heuristic_t heuristic - callable as weight_t(const data_t& vertex, const data_t& target);
+* it must never overestimate the cost of the path from 'vertex' to 'target', or the path found may be longer
+* @return an object containing the path
+* @throw error_t(problem_t::out_of_range) - if 'source' or 'target' is absent in the snapshot
+* @throw error_t(problem_t::negative_weight) - if any edge of the snapshot has negative weight
 */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::insert_vertex(key_t key, data_t data)
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heuristic_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::A_star(
+	key_t source, key_t target, heuristic_t heuristic)
 {
-	incidences.insert(std::pair<key_t, vertex_t>(key, vertex_t(data)));
-	++graph_order;
+	uint32_t initial = index->id(source), terminal = index->id(target);
+	const data_t none = data_t();
+	return A_star_ids(initial, terminal, heuristic,
+		[this, &none](uint32_t vertex) -> const data_t& { return data == nullptr ? none : data[vertex]; });
 }
 
-/** Erases vertex 'key' and all edges incident on it.
-* @param key_t key - the key of the vertex that should be erased
+/** Runs the A* algorithm from vertex 'initial' to vertex 'terminal'; see A_star().
+* @param payload_t datum - a callable giving the data of the vertex of an index, to pass to 'heuristic'
 */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::erase_vertex(key_t key)
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class heuristic_t, class payload_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::A_star_ids(
+	uint32_t initial, uint32_t terminal, heuristic_t& heuristic, payload_t datum)
 {
-	if (incidences.find(key) == incidences.end())
-		return;
-	graph_size -= incidences[key].outedges.size();
-	incidences.erase(key);
-	--graph_order;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	if (negative())
+		throw error_t(problem_t::negative_weight);
+	const data_t& goal = datum(terminal);
+	std::vector<weight_t> distance(order(), infinity);
+	std::vector<uint32_t> predecessor(order(), no_vertex);
+	std::vector<size_t> via(order(), 0);
+	d_ary_heap_t<weight_t> heap(order());
+	distance[initial] = weight_t();
+	heap.push(initial, heuristic(datum(initial), goal));
+	while (not heap.empty())
 	{
-		auto o = i->second.outedges.begin();
-		while (o != i->second.outedges.end())
+		uint32_t closest = heap.pop();
+		if (closest == terminal)
+			break;
+		for (size_t e = offsets[closest]; e < offsets[closest + 1]; ++e)
 		{
-			if (o->head == key)
+			uint32_t head = heads[e];
+			weight_t length = distance[closest] + weights[e];
+			if (length < distance[head])
 			{
-				o = i->second.outedges.erase(o);
-				--graph_size;
+				weight_t estimate = length + heuristic(datum(head), goal);
+				if (heap.contains(head))
+					heap.decrease(head, estimate);
+				else
+					heap.push(head, estimate);
+				distance[head] = length;
+				predecessor[head] = closest;
+				via[head] = ordinals[e];
 			}
-			else
-				++o;
 		}
 	}
+	return route(initial, terminal, distance[terminal], predecessor, via);
 }
 
-/** Moves the data associated with vertex 'key' to a newly created vertex 'new_key'.
-* The old vertex is erased and 'key' is replaced by 'new_key' in all the edges.
-* @param key_t key - the key to be replaced
-* @param key_t new_key - the key to replace with
-* @throw error_t(problem_t::out_of_range) - if 'key' is absent in the graph
-* @throw error_t(problem_t::invalid_value) - if 'new_key' is already present in the graph
+/** Collects the path from 'initial' to 'terminal' of cost 'cost' by following the predecessors back
+* from 'terminal'. An infinite cost leaves the path empty.
 */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::reset_key(key_t key, key_t new_key)
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::route(
+	uint32_t initial, uint32_t terminal, weight_t cost, const std::vector<uint32_t>& predecessor, const std::vector<size_t>& via)
 {
-	if (key == new_key)
-		return;
-	if (incidences.find(key) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	if (incidences.find(new_key) != incidences.end())
-		throw error_t(problem_t::invalid_value);
-	incidences[new_key] = std::move(incidences[key]);
-	incidences.erase(key);
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	OneToOne_t results;
+	results.index = index;
+	results.cost = cost;
+	if (cost == infinity)
+		return results;
+	for (uint32_t vertex = terminal; vertex != initial; vertex = predecessor[vertex])
 	{
-		auto o = i->second.outedges.begin();
-		while (o != i->second.outedges.end())
-		{
-			if (o->head == key)
-				o->head = new_key;
-			++o;
-		}
+		results.vertices.push_back(vertex);
+		results.edges.push_back(via[vertex]);
 	}
+	results.vertices.push_back(initial);
+	std::reverse(results.vertices.begin(), results.vertices.end());
+	std::reverse(results.edges.begin(), results.edges.end());
+	return results;
 }
 
-/** Resets the data assigned to vertex 'key'.
-* @param key_t key - the key of the vertex whose data should be reset
-* @param data_t new_data - the new data that should be assigned to the vertex
-* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+/** Solves the all-pairs shortest paths problem on the snapshot by means of the Floyd-Warshall algorithm.
+* The computation runs on row-major matrices indexed by the dense indices of the vertices,
+* processed in tiles small enough to stay in the cache. The tiles of the same phase are independent
+* and shared among the threads, so the result does not depend on their number.
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'hop_t' cannot index all the vertices
+* @throw error_t(problem_t::negative_cycle) - if the snapshot contains a cycle of negative weight
 */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::reset_data(key_t key, data_t new_data)
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::template AllToAll_table_t<cost_t, hop_t>
+my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::Floyd_Warshall(size_t threads)
 {
-	if (incidences.find(key) == incidences.end())
+	using table_t = AllToAll_table_t<cost_t, hop_t>;
+	size_t n = order();
+	if (n >= table_t::no_hop)
 		throw error_t(problem_t::out_of_range);
-	incidences[key].data = new_data;
+	table_t results;
+	results.index = index;
+	results.distance.assign(n * n, infinite_cost<cost_t>());
+	results.successor.assign(n * n, table_t::no_hop);
+	cost_t* costs = results.distance.data();
+	hop_t* hops = results.successor.data();
+	for (uint32_t i = 0; i < n; ++i)
+	{
+		costs[i * n + i] = cost_t();
+		hops[i * n + i] = static_cast<hop_t>(i);
+		for (size_t e = offsets[i]; e < offsets[i + 1]; ++e)
+		{
+			if (heads[e] != i and static_cast<cost_t>(weights[e]) < costs[i * n + heads[e]])
+			{
+				costs[i * n + heads[e]] = static_cast<cost_t>(weights[e]);
+				hops[i * n + heads[e]] = static_cast<hop_t>(heads[e]);
+			}
+		}
+	}
+	// Each round finishes the diagonal tile of the pivots first, then the tiles sharing its rows
+	// or columns, and at last all the others, which depend only on the tiles of the former phases.
+	size_t tiles = (n + tile - 1) / tile;
+	for (size_t k = 0; k < tiles; ++k)
+	{
+		relax_tile(costs, hops, n, k, k, k);
+		parallel_for(2 * tiles, threads, [&](size_t t)
+		{
+			if (t / 2 != k)
+			{
+				if (t % 2)
+					relax_tile(costs, hops, n, t / 2, k, k);
+				else
+					relax_tile(costs, hops, n, k, t / 2, k);
+			}
+		});
+		parallel_for(tiles, threads, [&](size_t i)
+		{
+			if (i == k)
+				return;
+			for (size_t j = 0; j < tiles; ++j)
+			{
+				if (j != k)
+					relax_tile(costs, hops, n, i, j, k);
+			}
+		});
+	}
+	for (size_t i = 0; i < n; ++i)
+	{
+		if (costs[i * n + i] < cost_t())
+			throw error_t(problem_t::negative_cycle);
+	}
+	lightest_edges(results.offsets, results.heads, results.ordinals);
+	return results;
 }
 
-/** Returns reference to the data assigned to vertex 'key'.
-* @param key_t key - the vertex whose data should be accessed
-* @return reference to the data
-* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+/** Solves the all-pairs shortest paths problem on the snapshot by means of the Johnson's algorithm.
+* The edges are reweighted by the potentials of the vertices so that none is negative, and then the
+* Dijkstra's algorithm runs from every vertex; the sources are shared among the threads.
+* @param size_t threads - the number of the threads sharing the computation
+* @return an object containing the solution to the problem
+* @throw error_t(problem_t::out_of_range) - if 'hop_t' cannot index all the vertices
+* @throw error_t(problem_t::negative_cycle) - if the snapshot contains a cycle of negative weight
 */
-template<class key_t, class data_t, class weight_t>
-data_t& my_graph<key_t, data_t, weight_t>::vertex_data(key_t key)
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::template AllToAll_table_t<cost_t, hop_t>
+my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::Johnson(size_t threads)
 {
-	if (incidences.find(key) == incidences.end())
+	using table_t = AllToAll_table_t<cost_t, hop_t>;
+	size_t n = order();
+	if (n >= table_t::no_hop)
 		throw error_t(problem_t::out_of_range);
-	return incidences[key].data;
+	std::vector<weight_t> potential = potentials();
+	std::vector<weight_t> reduced(size());
+	for (uint32_t tail = 0; tail < n; ++tail)
+	{
+		for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+			reduced[e] = std::max(weight_t(), static_cast<weight_t>(weights[e] + potential[tail] - potential[heads[e]]));
+	}
+	table_t results;
+	results.index = index;
+	results.distance.assign(n * n, infinite_cost<cost_t>());
+	results.successor.assign(n * n, table_t::no_hop);
+	// The sources are handed out in blocks, which reuse the same working arrays.
+	const size_t block = 64;
+	parallel_for((n + block - 1) / block, threads, [&](size_t b)
+	{
+		std::vector<weight_t> distance(n, infinity);
+		std::vector<uint32_t> predecessor(n, no_vertex);
+		std::vector<uint32_t> settled;
+		settled.reserve(n);
+		d_ary_heap_t<weight_t> heap(n);
+		for (uint32_t initial = static_cast<uint32_t>(b * block); initial < std::min(n, (b + 1) * block); ++initial)
+		{
+			distance[initial] = weight_t();
+			heap.push(initial, distance[initial]);
+			while (not heap.empty())
+			{
+				uint32_t closest = heap.pop();
+				settled.push_back(closest);
+				for (size_t e = offsets[closest]; e < offsets[closest + 1]; ++e)
+				{
+					uint32_t head = heads[e];
+					weight_t length = distance[closest] + reduced[e];
+					if (length < distance[head])
+					{
+						if (heap.contains(head))
+							heap.decrease(head, length);
+						else
+							heap.push(head, length);
+						distance[head] = length;
+						predecessor[head] = closest;
+					}
+				}
+			}
+			// The vertices are settled after their predecessors, so the first hop of each path
+			// is inherited from the predecessor.
+			cost_t* costs = results.distance.data() + initial * n;
+			hop_t* hops = results.successor.data() + initial * n;
+			for (auto v = settled.begin(); v != settled.end(); ++v)
+			{
+				costs[*v] = static_cast<cost_t>(distance[*v] - potential[initial] + potential[*v]);
+				hops[*v] = *v == initial or predecessor[*v] == initial ? static_cast<hop_t>(*v) : hops[predecessor[*v]];
+				distance[*v] = infinity;
+				predecessor[*v] = no_vertex;
+			}
+			settled.clear();
+		}
+	});
+	lightest_edges(results.offsets, results.heads, results.ordinals);
+	return results;
 }
 
-/** Counts the input degree of vertex 'key'.
-* @param key_t key - the vertex whose input degree should be counted
-* @return the number of edges leading to the vertex
-* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+/** Computes the potentials of the Johnson's reweighting: the costs of the shortest paths to every
+* vertex from a virtual source joined to all of them by edges of weight 0, found by the Bellman-Ford
+* algorithm. With the potentials 'p', no edge (u, v) has negative weight w(u, v) + p(u) - p(v).
+* @throw error_t(problem_t::negative_cycle) - if the snapshot contains a cycle of negative weight
 */
-template<class key_t, class data_t, class weight_t>
-size_t my_graph<key_t, data_t, weight_t>::indegree(key_t key)
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<weight_t> my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::potentials()
 {
-	if (incidences.find(key) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	size_t count = 0;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	std::vector<weight_t> potential(order(), weight_t());
+	for (size_t count = 0; ; ++count)
 	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
+		bool finish = true;
+		for (uint32_t tail = 0; tail < order(); ++tail)
 		{
-			if (o->head == key)
-				++count;
+			for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+			{
+				if (potential[tail] + weights[e] < potential[heads[e]])
+				{
+					finish = false;
+					potential[heads[e]] = potential[tail] + weights[e];
+				}
+			}
 		}
+		if (finish)
+			return potential;
+		if (count == order())
+			throw error_t(problem_t::negative_cycle);
 	}
-	return count;
 }
 
-/** Counts the output degree of vertex 'key'.
-* @param key_t key - the vertex whose output degree should be counted
-* @return the number of edges going out from the vertex
-* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+/** Builds a contraction hierarchy of the snapshot. The vertices are contracted in rounds: each round
+* takes the vertices whose edge difference (the shortcuts their contraction needs, less the arcs it removes,
+* plus the neighbours already contracted) is lower than that of all their remaining neighbours, and
+* contracts them at once. For every pair of arcs (u, v), (v, w) through a contracted vertex 'v', a local
+* search looks for a path from 'u' to 'w' avoiding 'v' and the other vertices of the round that is no longer;
+* if there is none, a shortcut (u, w) replaces the pair. The searches are shared among the threads.
+* @param size_t threads - the number of the threads sharing the computation
+* @return the hierarchy
+* @throw error_t(problem_t::negative_weight) - if any edge of the snapshot has negative weight
 */
-template<class key_t, class data_t, class weight_t>
-size_t my_graph<key_t, data_t, weight_t>::outdegree(key_t key)
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::contract(size_t threads)
 {
-	if (incidences.find(key) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	return incidences[key].outedges.size();
+	using arc_t = typename hierarchy_t::arc_t;
+	if (negative())
+		throw error_t(problem_t::negative_weight);
+	const size_t n = order();
+	hierarchy_t results;
+	results.index = index;
+	results.rank.assign(n, no_vertex);
+	// The arcs between the remaining vertices, at most one from each vertex to another.
+	std::vector<std::vector<size_t>> out(n), in(n);
+	std::vector<size_t> best(n, hierarchy_t::no_arc);
+	for (uint32_t tail = 0; tail < n; ++tail)
+	{
+		for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+		{
+			uint32_t head = heads[e];
+			if (head == tail)
+				continue;
+			if (best[head] == hierarchy_t::no_arc)
+			{
+				best[head] = results.arcs.size();
+				out[tail].push_back(best[head]);
+				in[head].push_back(best[head]);
+				results.arcs.push_back(arc_t{ tail, head, weights[e], ordinals[e], hierarchy_t::no_arc });
+			}
+			else if (weights[e] < results.arcs[best[head]].weight)
+				results.arcs[best[head]] = arc_t{ tail, head, weights[e], ordinals[e], hierarchy_t::no_arc };
+		}
+		for (auto a = out[tail].begin(); a != out[tail].end(); ++a)
+			best[results.arcs[*a].head] = hierarchy_t::no_arc;
+	}
+	// The working arrays of a witness search, reused by one thread.
+	struct witness_t
+	{
+		std::vector<weight_t> distance;
+		std::vector<uint32_t> reached;
+		std::vector<char> target;
+		d_ary_heap_t<weight_t> heap;
+		witness_t(size_t n) : distance(n, infinity), target(n, 0), heap(n) {}
+	};
+	// The states of the vertices: remaining, being contracted in the current round, contracted.
+	enum : char { remaining, selected, contracted };
+	std::vector<char> state(n, remaining);
+	const size_t settle_limit = 500;
+	// Lists the shortcuts that the contraction of vertex 'v' requires, as pairs of arcs.
+	auto shortcuts = [&](uint32_t v, witness_t& space, std::vector<std::pair<size_t, size_t>>& found)
+	{
+		found.clear();
+		weight_t longest = weight_t();
+		for (auto b = out[v].begin(); b != out[v].end(); ++b)
+		{
+			longest = std::max(longest, results.arcs[*b].weight);
+			space.target[results.arcs[*b].head] = 1;
+		}
+		for (auto a = in[v].begin(); a != in[v].end(); ++a)
+		{
+			uint32_t initial = results.arcs[*a].tail;
+			weight_t limit = results.arcs[*a].weight + longest;
+			size_t targets = out[v].size();
+			space.distance[initial] = weight_t();
+			space.reached.push_back(initial);
+			space.heap.push(initial, weight_t());
+			for (size_t settled = 0; not space.heap.empty() and settled < settle_limit; ++settled)
+			{
+				uint32_t closest = space.heap.pop();
+				if (space.distance[closest] > limit or (space.target[closest] and --targets == 0))
+					break;
+				for (auto c = out[closest].begin(); c != out[closest].end(); ++c)
+				{
+					uint32_t head = results.arcs[*c].head;
+					weight_t length = space.distance[closest] + results.arcs[*c].weight;
+					if (state[head] != remaining or head == v or not (length < space.distance[head]))
+						continue;
+					if (space.distance[head] == infinity)
+						space.reached.push_back(head);
+					if (space.heap.contains(head))
+						space.heap.decrease(head, length);
+					else
+						space.heap.push(head, length);
+					space.distance[head] = length;
+				}
+			}
+			for (auto b = out[v].begin(); b != out[v].end(); ++b)
+			{
+				uint32_t terminal = results.arcs[*b].head;
+				if (terminal != initial and results.arcs[*a].weight + results.arcs[*b].weight < space.distance[terminal])
+					found.emplace_back(*a, *b);
+			}
+			while (not space.heap.empty())
+				space.heap.pop();
+			for (auto r = space.reached.begin(); r != space.reached.end(); ++r)
+				space.distance[*r] = infinity;
+			space.reached.clear();
+		}
+		for (auto b = out[v].begin(); b != out[v].end(); ++b)
+			space.target[results.arcs[*b].head] = 0;
+	};
+	// Runs 'body(space, i)' for every 'i' in [0, count) on the threads, each with its own working arrays.
+	std::vector<witness_t> spaces;
+	for (size_t t = 0; t < std::max<size_t>(threads, 1); ++t)
+		spaces.emplace_back(n);
+	auto share = [&](size_t count, auto body)
+	{
+		std::atomic<size_t> next(0);
+		parallel_for(spaces.size(), spaces.size(), [&](size_t t)
+		{
+			for (size_t i = next++; i < count; i = next++)
+				body(spaces[t], i);
+		});
+	};
+	std::vector<long long> priority(n, 0);
+	std::vector<size_t> removed(n, 0);
+	auto estimate = [&](witness_t& space, uint32_t v)
+	{
+		std::vector<std::pair<size_t, size_t>> found;
+		shortcuts(v, space, found);
+		priority[v] = static_cast<long long>(found.size()) - static_cast<long long>(in[v].size() + out[v].size())
+			+ static_cast<long long>(removed[v]);
+	};
+	share(n, [&](witness_t& space, size_t v) { estimate(space, static_cast<uint32_t>(v)); });
+	std::vector<uint32_t> left(n);
+	for (uint32_t v = 0; v < n; ++v)
+		left[v] = v;
+	uint32_t next_rank = 0;
+	std::vector<uint32_t> round, touched;
+	std::vector<std::vector<std::pair<size_t, size_t>>> found;
+	std::vector<char> marked(n, 0), superseded;
+	while (not left.empty())
+	{
+		auto lower = [&](uint32_t v, uint32_t w) { return std::make_pair(priority[v], v) < std::make_pair(priority[w], w); };
+		round.clear();
+		for (auto v = left.begin(); v != left.end(); ++v)
+		{
+			bool least = true;
+			for (auto a = in[*v].begin(); least and a != in[*v].end(); ++a)
+			{
+				uint32_t w = results.arcs[*a].tail;
+				least = lower(*v, w);
+				for (auto b = in[w].begin(); least and b != in[w].end(); ++b)
+					least = results.arcs[*b].tail == *v or lower(*v, results.arcs[*b].tail);
+				for (auto b = out[w].begin(); least and b != out[w].end(); ++b)
+					least = results.arcs[*b].head == *v or lower(*v, results.arcs[*b].head);
+			}
+			for (auto a = out[*v].begin(); least and a != out[*v].end(); ++a)
+			{
+				uint32_t w = results.arcs[*a].head;
+				least = lower(*v, w);
+				for (auto b = in[w].begin(); least and b != in[w].end(); ++b)
+					least = results.arcs[*b].tail == *v or lower(*v, results.arcs[*b].tail);
+				for (auto b = out[w].begin(); least and b != out[w].end(); ++b)
+					least = results.arcs[*b].head == *v or lower(*v, results.arcs[*b].head);
+			}
+			if (least)
+				round.push_back(*v);
+		}
+		for (auto v = round.begin(); v != round.end(); ++v)
+			state[*v] = selected;
+		found.resize(round.size());
+		share(round.size(), [&](witness_t& space, size_t i) { shortcuts(round[i], space, found[i]); });
+		touched.clear();
+		for (size_t i = 0; i < round.size(); ++i)
+		{
+			uint32_t v = round[i];
+			for (auto f = found[i].begin(); f != found[i].end(); ++f)
+			{
+				arc_t shortcut{ results.arcs[f->first].tail, results.arcs[f->second].head,
+					results.arcs[f->first].weight + results.arcs[f->second].weight, f->first, f->second };
+				auto existing = std::find_if(out[shortcut.tail].begin(), out[shortcut.tail].end(),
+					[&](size_t a) { return results.arcs[a].head == shortcut.head; });
+				if (existing != out[shortcut.tail].end() and not (shortcut.weight < results.arcs[*existing].weight))
+					continue;
+				if (results.arcs.size() >= std::numeric_limits<uint32_t>::max())
+					throw error_t(problem_t::out_of_range);
+				size_t arc = results.arcs.size();
+				results.arcs.push_back(shortcut);
+				if (existing != out[shortcut.tail].end())
+				{
+					superseded.resize(results.arcs.size(), 0);
+					superseded[*existing] = 1;
+					*std::find(in[shortcut.head].begin(), in[shortcut.head].end(), *existing) = arc;
+					*existing = arc;
+				}
+				else
+				{
+					out[shortcut.tail].push_back(arc);
+					in[shortcut.head].push_back(arc);
+				}
+			}
+			for (auto a = in[v].begin(); a != in[v].end(); ++a)
+			{
+				uint32_t tail = results.arcs[*a].tail;
+				out[tail].erase(std::find(out[tail].begin(), out[tail].end(), *a));
+				++removed[tail];
+				touched.push_back(tail);
+			}
+			for (auto a = out[v].begin(); a != out[v].end(); ++a)
+			{
+				uint32_t head = results.arcs[*a].head;
+				in[head].erase(std::find(in[head].begin(), in[head].end(), *a));
+				++removed[head];
+				touched.push_back(head);
+			}
+			std::vector<size_t>().swap(in[v]);
+			std::vector<size_t>().swap(out[v]);
+			state[v] = contracted;
+			results.rank[v] = next_rank++;
+		}
+		left.erase(std::remove_if(left.begin(), left.end(), [&](uint32_t v) { return state[v] == contracted; }), left.end());
+		auto unique = std::remove_if(touched.begin(), touched.end(), [&](uint32_t v)
+		{
+			if (marked[v] or state[v] != remaining)
+				return true;
+			marked[v] = 1;
+			return false;
+		});
+		touched.erase(unique, touched.end());
+		share(touched.size(), [&](witness_t& space, size_t i) { estimate(space, touched[i]); });
+		for (auto v = touched.begin(); v != touched.end(); ++v)
+			marked[*v] = 0;
+	}
+	// The arcs replaced by lighter shortcuts are kept only for unpacking, outside the searched lists.
+	superseded.resize(results.arcs.size(), 0);
+	results.up_offsets.assign(n + 1, 0);
+	results.down_offsets.assign(n + 1, 0);
+	for (size_t a = 0; a < results.arcs.size(); ++a)
+	{
+		const arc_t& arc = results.arcs[a];
+		if (superseded[a])
+			continue;
+		if (results.rank[arc.tail] < results.rank[arc.head])
+			++results.up_offsets[arc.tail + 1];
+		else
+			++results.down_offsets[arc.head + 1];
+	}
+	for (size_t v = 0; v < n; ++v)
+	{
+		results.up_offsets[v + 1] += results.up_offsets[v];
+		results.down_offsets[v + 1] += results.down_offsets[v];
+	}
+	results.up.resize(results.up_offsets[n]);
+	results.down.resize(results.down_offsets[n]);
+	std::vector<size_t> up_fill(results.up_offsets.begin(), results.up_offsets.end() - 1);
+	std::vector<size_t> down_fill(results.down_offsets.begin(), results.down_offsets.end() - 1);
+	for (size_t a = 0; a < results.arcs.size(); ++a)
+	{
+		const arc_t& arc = results.arcs[a];
+		if (superseded[a])
+			continue;
+		if (results.rank[arc.tail] < results.rank[arc.head])
+			results.up[up_fill[arc.tail]++] = static_cast<uint32_t>(a);
+		else
+			results.down[down_fill[arc.head]++] = static_cast<uint32_t>(a);
+	}
+	return results;
 }
 
-/** Counts the degree of vertex 'key'.
-* @param key_t key - the vertex whose degree should be counted
-* @return the number of edges incident on the vertex
-* @throw error_t(problem_t::out_of_range) - if vertex 'key' is absent in the graph
+/** Relaxes the tile ('row', 'column') of the n x n matrices through the pivots of tile 'pivot'.
+* The inner loop has no branches, so that the compiler can vectorise it.
 */
-template<class key_t, class data_t, class weight_t>
-size_t my_graph<key_t, data_t, weight_t>::degree(key_t key)
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::relax_tile(cost_t* distance, hop_t* successor,
+	size_t n, size_t row, size_t column, size_t pivot)
 {
-	if (incidences.find(key) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	size_t count = incidences[key].outedges.size();
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	size_t rows_end = std::min(n, (row + 1) * tile), columns_end = std::min(n, (column + 1) * tile);
+	size_t pivots_end = std::min(n, (pivot + 1) * tile);
+	for (size_t k = pivot * tile; k < pivots_end; ++k)
 	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
+		const cost_t* via = distance + k * n;
+		for (size_t i = row * tile; i < rows_end; ++i)
 		{
-			if (o->head == key)
-				++count;
+			cost_t first = distance[i * n + k];
+			if (first == infinite_cost<cost_t>())
+				continue;
+			hop_t hop = successor[i * n + k];
+			cost_t* cost = distance + i * n;
+			hop_t* next = successor + i * n;
+			for (size_t j = column * tile; j < columns_end; ++j)
+			{
+				cost_t candidate = extend_cost(via[j], first);
+				bool shorter = candidate < cost[j];
+				cost[j] = shorter ? candidate : cost[j];
+				next[j] = shorter ? hop : next[j];
+			}
 		}
 	}
-	return count;
 }
 
-/** Counts the degrees of the vertices and returns the greatest one.
-* @return degree of the graph
-* @throw error_t(problem_t::empty_graph) - if the graph is empty
+/** Lists the lightest edge from every vertex to each of its adjacent vertices, in the layout of
+* AllToAll_table_t: the heads adjacent to vertex 'v' occupy [lightest_offsets[v], lightest_offsets[v + 1])
+* in increasing order, each along with the ordinal number of the edge.
 */
-template<class key_t, class data_t, class weight_t>
-size_t my_graph<key_t, data_t, weight_t>::degree()
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::lightest_edges(std::vector<size_t>& lightest_offsets,
+	std::vector<uint32_t>& lightest_heads, std::vector<size_t>& lightest_ordinals)
 {
-	if (incidences.empty())
-		throw error_t(problem_t::empty_graph);
-	std::unordered_map<key_t, size_t> counts;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-		counts.insert(std::pair<key_t, size_t>(i->first, i->second.outedges.size()));
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	const size_t none = std::numeric_limits<size_t>::max();
+	std::vector<size_t> best(order(), none);
+	lightest_offsets.assign(1, 0);
+	lightest_offsets.reserve(order() + 1);
+	lightest_heads.clear();
+	lightest_ordinals.clear();
+	for (uint32_t tail = 0; tail < order(); ++tail)
 	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
-			++counts[o->head];
-	}
-	size_t max_count = 0;
-	for (auto c = counts.begin(); c != counts.end(); ++c)
-	{
-		if (c->second > max_count)
-			max_count = c->second;
+		size_t start = lightest_heads.size();
+		for (size_t e = offsets[tail]; e < offsets[tail + 1]; ++e)
+		{
+			if (best[heads[e]] == none)
+			{
+				best[heads[e]] = e;
+				lightest_heads.push_back(heads[e]);
+			}
+			else if (weights[e] < weights[best[heads[e]]])
+				best[heads[e]] = e;
+		}
+		std::sort(lightest_heads.begin() + start, lightest_heads.end());
+		for (size_t k = start; k < lightest_heads.size(); ++k)
+		{
+			lightest_ordinals.push_back(ordinals[best[lightest_heads[k]]]);
+			best[lightest_heads[k]] = none;
+		}
+		lightest_offsets.push_back(lightest_heads.size());
 	}
-	return max_count;
 }
 
-/** Inserts an edge from 'tail' to 'head', provided such vertices are present in the graph,
- * and assigns it with 'weight', that is equal to 0.0 by default.
- * @param key_t tail - the initial vertex of the edge
- * @param key_t head - the terminal vertex of the edge
- * @param weight_t weight - the weight that should be assigned to the edge
- * @throw error_t(problem_t::out_of_range) - if vertices 'tail' and 'head' are absent in the graph
- */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::insert_edge(key_t tail, key_t head, weight_t weight)
+/** Wraps the arrays computed by a single-source algorithm into the object returned to the user.
+* The arrays are moved from.
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t my_graph<key_t, data_t, weight_t, policy_t>::snapshot_t::solution(
+	uint32_t initial, std::vector<weight_t>& distance, std::vector<uint32_t>& predecessor, std::vector<size_t>& via)
+{
+	OneToAll_t results;
+	results.index = index;
+	results.initial = initial;
+	results.distance = std::move(distance);
+	results.predecessor = std::move(predecessor);
+	results.via = std::move(via);
+	return results;
+}
+
+/** Returns the cost of the shortest path from the initial vertex to 'terminal'.
+* @return the cost of the path, or infinity if 'terminal' is unreachable
+* @throw error_t(problem_t::out_of_range) - if 'terminal' was absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+weight_t my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t::path_cost(key_t terminal) const
 {
-	if (incidences.find(tail) == incidences.end() or incidences.find(head) == incidences.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	incidences[tail].outedges.emplace_back(edge_t(++edges_count, head, weight));
-	++graph_size;
+	return distance[index->id(terminal)];
 }
 
- /** Inserts two edges: from 'tail' to 'head' and from 'head' to 'tail',
-* and assigns them with 'weight', that is equal to 0.0 by default.
-* @param key_t tail - an endpoint of the edges
-* @param key_t head - the other endpoint of the edges
-* @param weight_t weight - the weight that should be assigned to the edges
-* @throw error_t(problem_t::out_of_range) - if vertices 'tail' and 'head' are absent in the graph
+/** Returns the vertices of the shortest path from the initial vertex to 'terminal'.
+* @return the keys of the vertices, beginning with the initial one; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'terminal' was absent in the graph
 */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::insert_undirected_edge(key_t tail, key_t head, weight_t weight)
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<key_t> my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t::path_vertices(key_t terminal) const
 {
-	if (incidences.find(tail) == incidences.end() or incidences.find(head) == incidences.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	incidences[tail].outedges.emplace_back(edge_t(++edges_count, head, weight));
-	incidences[head].outedges.emplace_back(edge_t(++edges_count, tail, weight));
-	graph_size += 2;
+	std::vector<key_t> path;
+	uint32_t vertex = index->id(terminal);
+	if (predecessor[vertex] == no_vertex)
+		return path;
+	for (; predecessor[vertex] != no_vertex; vertex = predecessor[vertex])
+		path.push_back(index->keys[vertex]);
+	path.push_back(index->keys[vertex]);
+	std::reverse(path.begin(), path.end());
+	return path;
 }
 
-/** Returns the ordinal numbers of edges from 'tail' to 'head'.
-* @param key_t tail - the initial vertex of the edges
-* @param key_t head - the terminal vertex of the edges
-* @return the vector of ordinal numbers of the edges
-* @throw error_t(problem_t::out_of_range) - if 'tail' or 'head' is absent in the graph
+/** Returns the edges of the shortest path from the initial vertex to 'terminal'.
+* @return the ordinal numbers of the edges, in the order of the path; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'terminal' was absent in the graph
 */
-template<class key_t, class data_t, class weight_t>
-std::vector<size_t> my_graph<key_t, data_t, weight_t>::edges(key_t tail, key_t head)
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t::path_edges(key_t terminal) const
 {
-	if (incidences.find(tail) == incidences.end() or incidences.find(head) == incidences.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	std::vector<size_t> numbers;
-	for (auto o = incidences[tail].outedges.begin(); o != incidences[tail].outedges.end(); ++o)
-	{
-		if (o->head == head)
-			numbers.push_back(o->ordinal);
-	}
-	return numbers;
+	std::vector<size_t> path;
+	for (uint32_t vertex = index->id(terminal); predecessor[vertex] != no_vertex; vertex = predecessor[vertex])
+		path.push_back(via[vertex]);
+	std::reverse(path.begin(), path.end());
+	return path;
 }
 
-/** Returns the ordinal numbers of edges outgoing from 'tail'.
-* @param key_t tail - the initial vertex of the edges
-* @return the vector of ordinal numbers of the edges
-* @throw error_t(problem_t::out_of_range) - if 'tail' is absent in the graph
+/** Returns the source nearest to 'terminal': the initial vertex, or the first vertex of the shortest path
+* after a search from several sources.
+* @throw error_t(problem_t::out_of_range) - if 'terminal' was absent in the graph
+* @throw error_t(problem_t::no_path) - if 'terminal' is unreachable
 */
-template<class key_t, class data_t, class weight_t>
-std::vector<size_t> my_graph<key_t, data_t, weight_t>::outedges(key_t tail)
+template<class key_t, class data_t, class weight_t, class policy_t>
+key_t my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t::nearest_source(key_t terminal) const
 {
-	if (incidences.find(tail) == incidences.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	std::vector<size_t> numbers;
-	for (auto o = incidences[tail].outedges.begin(); o != incidences[tail].outedges.end(); ++o)
-		numbers.push_back(o->ordinal);
-	return numbers;
+	uint32_t vertex = index->id(terminal);
+	if (distance[vertex] == infinity)
+		throw error_t(problem_t::no_path);
+	return index->keys[origin.empty() ? initial : origin[vertex]];
 }
 
-/** Returns the ordinal numbers of edges leading to 'head'.
-* @param key_t head - the terminal vertex of the edges
-* @return the vector of ordinal numbers of the edges
-* @throw error_t(problem_t::out_of_range) - if 'head' is absent in the graph
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::OneToAll_t::clear()
+{
+	index.reset();
+	initial = no_vertex;
+	distance.clear();
+	predecessor.clear();
+	via.clear();
+	origin.clear();
+}
+
+/// Returns the row of 'source', or throws error_t(problem_t::out_of_range) if it was not a source.
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::ManyToAll_t::row(key_t source)
+{
+	if (not index)
+		throw error_t(problem_t::out_of_range);
+	auto found = rows.find(index->id(source));
+	if (found == rows.end())
+		throw error_t(problem_t::out_of_range);
+	return found->second * index->keys.size();
+}
+
+/** Returns the cost of the shortest path from 'source' to 'terminal'.
+* @return the cost of the path, or infinity if 'terminal' is unreachable
+* @throw error_t(problem_t::out_of_range) - if 'source' was not a source or 'terminal' was absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+weight_t my_graph<key_t, data_t, weight_t, policy_t>::ManyToAll_t::path_cost(key_t source, key_t terminal)
+{
+	size_t first = row(source);
+	return distance[first + index->id(terminal)];
+}
+
+/** Returns the vertices of the shortest path from 'source' to 'terminal'.
+* @return the keys of the vertices, beginning with 'source'; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'source' was not a source or 'terminal' was absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<key_t> my_graph<key_t, data_t, weight_t, policy_t>::ManyToAll_t::path_vertices(key_t source, key_t terminal)
+{
+	size_t first = row(source);
+	std::vector<key_t> path;
+	uint32_t vertex = index->id(terminal);
+	if (predecessor[first + vertex] == no_vertex)
+		return path;
+	for (; predecessor[first + vertex] != no_vertex; vertex = predecessor[first + vertex])
+		path.push_back(index->keys[vertex]);
+	path.push_back(index->keys[vertex]);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+/** Returns the edges of the shortest path from 'source' to 'terminal'.
+* @return the ordinal numbers of the edges, in the order of the path; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'source' was not a source or 'terminal' was absent in the graph
 */
-template<class key_t, class data_t, class weight_t>
-std::vector<size_t> my_graph<key_t, data_t, weight_t>::inedges(key_t head)
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::ManyToAll_t::path_edges(key_t source, key_t terminal)
+{
+	size_t first = row(source);
+	std::vector<size_t> path;
+	for (uint32_t vertex = index->id(terminal); predecessor[first + vertex] != no_vertex; vertex = predecessor[first + vertex])
+		path.push_back(via[first + vertex]);
+	std::reverse(path.begin(), path.end());
+	return path;
+}
+
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::ManyToAll_t::clear()
+{
+	index.reset();
+	sources.clear();
+	rows.clear();
+	distance.clear();
+	predecessor.clear();
+	via.clear();
+}
+
+/// Extends the arrays to 'order' vertices; the vertices inserted without edges are unreachable.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::grow(size_t order)
+{
+	if (distance.size() >= order)
+		return;
+	distance.resize(order, infinity);
+	predecessor.resize(order, no_vertex);
+	via.resize(order, 0);
+	cut_off.resize(order, 0);
+}
+
+/// Brings the paths up to date before a query.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::sync()
+{
+	if (graph == nullptr)
+		throw error_t(problem_t::out_of_range);
+	grow(graph->vertices.size());
+	if (stale)
+		recompute();
+}
+
+/// Computes the paths from scratch.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::recompute()
 {
-	if (incidences.find(head) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	std::vector<size_t> numbers;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	for (auto v = graph->vertices.begin(); v != graph->vertices.end(); ++v)
 	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
+		for (auto o = v->outedges.begin(); o != v->outedges.end(); ++o)
 		{
-			if (o->head == head)
-				numbers.push_back(o->ordinal);
+			if (o->weight < weight_t())
+				throw error_t(problem_t::negative_weight);
 		}
 	}
-	return numbers;
+	std::fill(distance.begin(), distance.end(), infinity);
+	std::fill(predecessor.begin(), predecessor.end(), no_vertex);
+	std::fill(via.begin(), via.end(), 0);
+	if (initial != no_vertex)
+	{
+		distance[initial] = weight_t();
+		queue.emplace(distance[initial], initial);
+		propagate();
+	}
+	stale = false;
 }
 
-template<class key_t, class data_t, class weight_t>
-size_t my_graph<key_t, data_t, weight_t>::shortest_edge(key_t tail, key_t head)
+/// Explores the outedges of the queued vertices in the order of their distances, until no distance improves.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::propagate()
 {
-	if (incidences.find(tail) == incidences.end() or incidences.find(head) == incidences.end())
-		return 0;
-	size_t number = 0;
-	weight_t weight = infinity;
-	for (auto o = incidences[tail].outedges.begin(); o != incidences[tail].end(); ++o)
+	while (not queue.empty())
 	{
-		if (o->head == head and o->weight < weight)
-		{
-			number = o->ordinal;
-			weight = o->weight;
-		}
+		std::pair<weight_t, uint32_t> top = queue.top();
+		queue.pop();
+		if (distance[top.second] < top.first)
+			continue;
+		const edges_t& outedges = graph->vertices[top.second].outedges;
+		for (auto o = outedges.begin(); o != outedges.end(); ++o)
+			improve(top.second, o->head, o->weight, o->ordinal);
 	}
-	return number;
 }
 
-/** Erases the edge with ordinal 'number'. The edge is sought in all the graph.
-* @param size_t number - the identifier of the edge that should be erased
+/// Relaxes the edge of ordinal 'ordinal' and queues its head if its distance improved.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::improve(uint32_t tail, uint32_t head, weight_t weight, size_t ordinal)
+{
+	weight_t length = extend_cost(distance[tail], weight);
+	if (length < distance[head])
+	{
+		distance[head] = length;
+		predecessor[head] = tail;
+		via[head] = ordinal;
+		queue.emplace(length, head);
+	}
+}
+
+/** Recomputes the subtree of the shortest paths rooted at 'root', after the edge of the tree leading to it
+* became heavier or was erased. The distances outside the subtree do not change.
 */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::erase_edge(size_t number)
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::cut(uint32_t root)
 {
-	if (number > edges_count)
-		return;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	subtree.assign(1, root);
+	cut_off[root] = 1;
+	for (size_t i = 0; i < subtree.size(); ++i)
 	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
+		uint32_t tail = subtree[i];
+		const edges_t& outedges = graph->vertices[tail].outedges;
+		for (auto o = outedges.begin(); o != outedges.end(); ++o)
 		{
-			if (o->ordinal == number)
+			if (not cut_off[o->head] and predecessor[o->head] == tail and via[o->head] == o->ordinal)
 			{
-				i->second.outedges.erase(o);
-				--graph_size;
-				return;
+				cut_off[o->head] = 1;
+				subtree.push_back(o->head);
 			}
 		}
 	}
-}
-
-/** Erases the edge with ordinal 'number'. The edge is sought only among the edges going out from 'tail'.
-* @param size_t number - the identifier of the edge that should be erased
-* @param key_t tail - the initial vertex of the edge
-*/
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::erase_edge(size_t number, key_t tail)
-{
-	if (number > edges_count)
-		return;
-	if (incidences.find(tail) == incidences.end())
-		return;
-	for (auto it = incidences[tail].outedges.begin(); it != incidences[tail].outedges.end(); ++it)
+	for (auto v = subtree.begin(); v != subtree.end(); ++v)
+	{
+		distance[*v] = infinity;
+		predecessor[*v] = no_vertex;
+		via[*v] = 0;
+	}
+	if constexpr (policy_t::inedges)
 	{
-		if (it->ordinal == number)
+		for (auto v = subtree.begin(); v != subtree.end(); ++v)
 		{
-			incidences[tail].outedges.erase(it);
-			--graph_size;
-			return;
+			const std::vector<size_t>& inedges = graph->vertices[*v].inedges;
+			for (auto i = inedges.begin(); i != inedges.end(); ++i)
+			{
+				const location_t& location = graph->locations[*i];
+				if (not cut_off[location.tail])
+					improve(location.tail, *v, graph->edge_at(location)->weight, *i);
+			}
 		}
 	}
-}
-
-/** Erases all the edges from vertex 'tail' to 'head'.
-* If no such vertices are present in the graph, nothing is done.
-* @param key_t tail - the initial vertex of the edge
-* @param key_t head - the terminal vertex of the edge
-*/
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::erase_edges(key_t tail, key_t head)
-{
-	if (incidences.find(tail) == incidences.end() or incidences.find(head) == incidences.end())
-		return;
-	auto o = incidences[tail].outedges.begin();
-	while (o != incidences[tail].outedges.end())
+	else
 	{
-		if (o->head == head)
+		for (uint32_t tail = 0; tail < graph->vertices.size(); ++tail)
 		{
-			--graph_size;
-			o = incidences[tail].outedges.erase(o);
+			if (cut_off[tail] or distance[tail] == infinity)
+				continue;
+			const edges_t& outedges = graph->vertices[tail].outedges;
+			for (auto o = outedges.begin(); o != outedges.end(); ++o)
+			{
+				if (cut_off[o->head])
+					improve(tail, o->head, o->weight, o->ordinal);
+			}
 		}
-		else
-			++o;
 	}
+	for (auto v = subtree.begin(); v != subtree.end(); ++v)
+		cut_off[*v] = 0;
+	propagate();
 }
 
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::erase_inedges(key_t head)
+/// Follows the insertion of the edge of ordinal 'ordinal'.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::inserted(uint32_t tail, uint32_t head, weight_t weight, size_t ordinal)
 {
-	if (incidences.find(head) == incidences.end())
+	grow(graph->vertices.size());
+	if (stale)
 		return;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	if (weight < weight_t())
 	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
-		{
-			if (o->head == head)
-			{
-				--graph_size;
-				o = i->second.outedges.erase(o);
-			}
-			else
-				++o;
-		}
+		stale = true;
+		return;
 	}
+	improve(tail, head, weight, ordinal);
+	propagate();
 }
 
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::erase_outedges(key_t tail)
+/// Follows the erasure of the edge of ordinal 'ordinal'.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::erased(uint32_t head, size_t ordinal)
 {
-	if (incidences.find(tail) == incidences.end())
+	grow(graph->vertices.size());
+	if (stale or predecessor[head] == no_vertex or via[head] != ordinal)
 		return;
-	graph_size -= incidences[tail].outedges.size();
-	incidences[tail].outedges.clear();
+	cut(head);
 }
 
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::reset_weight(size_t number, weight_t new_weight)
+/// Follows the change of the weight of the edge of ordinal 'ordinal' from 'weight' to 'new_weight'.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::reweighted(uint32_t tail, uint32_t head, weight_t weight,
+	weight_t new_weight, size_t ordinal)
 {
-	if (number > edges_count)
-		throw error_t(problem_t::out_of_range);
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
+	grow(graph->vertices.size());
+	if (stale)
+		return;
+	if (new_weight < weight_t())
+		stale = true;
+	else if (new_weight < weight)
 	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
-		{
-			if (o->ordinal == number)
-			{
-				o->weight = new_weight;
-				return;
-			}
-		}
+		improve(tail, head, new_weight, ordinal);
+		propagate();
 	}
+	else if (weight < new_weight and predecessor[head] != no_vertex and via[head] == ordinal)
+		cut(head);
 }
 
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::reset_weight(size_t number, weight_t new_weight, key_t tail)
+/// Follows the erasure of vertex 'victim', whose index was taken over by vertex 'last'.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::moved(uint32_t victim, uint32_t last)
 {
-	if (number > edges_count)
-		throw error_t(problem_t::out_of_range);
-	if (incidences.find(tail) == incidences.end())
+	grow(graph->vertices.size() + 1);
+	if (initial == victim)
+	{
+		lost();
 		return;
-	for (auto o = incidences[tail].outedges.begin(); o != incidences[tail].outedges.end(); ++o)
+	}
+	if (victim != last)
 	{
-		if (o->ordinal == number)
+		distance[victim] = distance[last];
+		predecessor[victim] = predecessor[last];
+		via[victim] = via[last];
+		const edges_t& outedges = graph->vertices[victim].outedges;
+		for (auto o = outedges.begin(); o != outedges.end(); ++o)
 		{
-			o->weight = new_weight;
-			return;
+			if (predecessor[o->head] == last and via[o->head] == o->ordinal)
+				predecessor[o->head] = victim;
 		}
+		if (initial == last)
+			initial = victim;
 	}
+	distance.pop_back();
+	predecessor.pop_back();
+	via.pop_back();
+	cut_off.pop_back();
 }
 
-/** Resets the weight of the edge from 'tail' to 'head'.
-* If no such are present in the graph or no edge joins them, nothing is done.
-* If more than one such edges are present, the weights of all of them are reset.
-* @param key_t tail
-* @param key_t head
-* @param weight_t new_weight
-* @throw
-*/
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::reset_weights(key_t tail, key_t head, weight_t new_weight)
+/// Follows the erasure of the source: no vertex is reachable any more.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::lost()
 {
-	if (incidences.find(tail) == incidences.end() or incidences.find(head) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	for (auto it = incidences[tail].outedges.begin(); it != incidences[tail].outedges.end(); ++it)
-	{
-		if (it->head == head)
-			it->weight = new_weight;
-	}
+	initial = no_vertex;
+	stale = false;
+	distance.clear();
+	predecessor.clear();
+	via.clear();
+	cut_off.clear();
 }
 
-template<class key_t, class data_t, class weight_t>
-weight_t& my_graph<key_t, data_t, weight_t>::edge_weight(size_t number)
+/** Returns the cost of the shortest path from the source to 'terminal' in the current graph.
+* @return the cost of the path, or infinity if 'terminal' is unreachable
+* @throw error_t(problem_t::out_of_range) - if 'terminal' is absent in the graph, or the graph was destroyed
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+weight_t my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::path_cost(key_t terminal)
 {
-	if (number > edges_count)
-		throw error_t(problem_t::out_of_range);
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-	{
-		for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
-		{
-			if (o->ordinal == number)
-				return o->weight;
-		}
-	}
+	sync();
+	return distance[graph->index->id(terminal)];
 }
 
-template<class key_t, class data_t, class weight_t>
-weight_t& my_graph<key_t, data_t, weight_t>::edge_weight(size_t number, key_t tail)
+/** Returns the vertices of the shortest path from the source to 'terminal' in the current graph.
+* @return the keys of the vertices, beginning with the source; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'terminal' is absent in the graph, or the graph was destroyed
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<key_t> my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::path_vertices(key_t terminal)
 {
-	if (number > edges_count or incidences.find(tail) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	for (auto o = incidences[tail].outedges.begin(); o != incidences[tail].outedges.end(); ++o)
-	{
-		if (o->ordinal == number)
-			return o->weight;
-	}
+	sync();
+	std::vector<key_t> path;
+	uint32_t vertex = graph->index->id(terminal);
+	if (predecessor[vertex] == no_vertex)
+		return path;
+	for (; predecessor[vertex] != no_vertex; vertex = predecessor[vertex])
+		path.push_back(graph->index->keys[vertex]);
+	path.push_back(graph->index->keys[vertex]);
+	std::reverse(path.begin(), path.end());
+	return path;
 }
 
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::clear()
+/** Returns the edges of the shortest path from the source to 'terminal' in the current graph.
+* @return the ordinal numbers of the edges, in the order of the path; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'terminal' is absent in the graph, or the graph was destroyed
+* @throw error_t(problem_t::negative_weight) - if any edge of the graph has negative weight
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::tracker_t::path_edges(key_t terminal)
 {
-	incidences.clear();
-	graph_order = 0;
-	graph_size = 0;
-	edges_count = 0;
+	sync();
+	std::vector<size_t> path;
+	for (uint32_t vertex = graph->index->id(terminal); predecessor[vertex] != no_vertex; vertex = predecessor[vertex])
+		path.push_back(via[vertex]);
+	std::reverse(path.begin(), path.end());
+	return path;
 }
 
-/** Performs breadth first search algorithm on the graph, beginning with vertex 'source'.
-* and executes 'function' for each vertex (the key as the first argument and the data as the second).
+/** Returns the level of 'vertex' in the breadth first tree.
+* @return the number of edges on the path from the initial vertex, or std::numeric_limits<size_t>::max()
+* if 'vertex' is unreachable
+* @throw error_t(problem_t::out_of_range) - if 'vertex' was absent in the graph
 */
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::breadth_first_search(std::function<void(key_t, data_t)> function, key_t source)
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::BreadthFirst_t::level(key_t vertex)
 {
-	if (incidences.empty())
-		return;
-	if (incidences.find(source) == incidences.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	std::unordered_map<key_t, bool> visited;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-		visited[i->first] = false;
-	visited[source] = true;
-	size_t count = incidences.size() - 1;
-	std::queue<key_t> vertices;
-	vertices.push(source);
-	function(source, incidences[source].data);
-	key_t vertex = source;
-	while (count > 0)
-	{
-		if (vertices.empty())
-		{
-			vertex = std::find_if_not(visited.begin(), visited.end(),
-				[](std::pair<key_t, bool> v) { return v.second; })->first;
-			function(vertex, incidences[vertex].data);
-			visited[vertex] = true;
-			--count;
-		}
-		else
-		{
-			vertex = vertices.front();
-			vertices.pop();
-		}
-		for (auto o = incidences[vertex].outedges.begin(); o != incidences[vertex].outedges.end(); ++o)
-		{
-			if (not visited.at(o->head))
-			{
-				function(o->head, incidences.at(o->head).data);
-				visited.at(o->head) = true;
-				--count;
-				vertices.push(o->head);
-			}
-		}
-	}
+	uint32_t depth = levels[index->id(vertex)];
+	return depth == no_vertex ? std::numeric_limits<size_t>::max() : depth;
 }
 
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::depth_first_search(std::function<void(key_t, data_t)> function, key_t source)
+/** Returns the parent of 'vertex' in the breadth first tree.
+* @return the key of the vertex preceding 'vertex' on its path from the initial vertex
+* @throw error_t(problem_t::out_of_range) - if 'vertex' was absent in the graph
+* @throw error_t(problem_t::no_path) - if 'vertex' is the initial vertex or is unreachable
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+key_t my_graph<key_t, data_t, weight_t, policy_t>::BreadthFirst_t::parent(key_t vertex)
 {
-	if (incidences.empty())
-		return;
-	if (incidences.find(source) == incidences.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	std::unordered_map<key_t, bool> visited;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-		visited[i->first] = false;
-	visited[source] = true;
-	size_t count = incidences.size() - 1;
-	std::stack<std::pair<key_t, typename std::list<edge_t>::iterator>> last_place;
-	key_t vertex = source;
-	typename std::list<edge_t>::iterator o = incidences[source].outedges.begin();
-	function(source, incidences[source].data);
-	while (count > 0)
-	{
-		while (o != incidences[vertex].outedges.end())
-		{
-			if (not visited[o->head])
-				break;
-			++o;
-		}
-		if (o == incidences[vertex].outedges.end())
-		{
-			if (last_place.empty())
-			{
-				vertex = std::find_if_not(visited.begin(), visited.end(),
-					[](std::pair<key_t, bool> p) { return p.second; })->first;
-				o = incidences[vertex].outedges.begin();
-				function(vertex, incidences[vertex].data);
-				visited[vertex] = true;
-				--count;
-			}
-			else
-			{
-				vertex = last_place.top().first;
-				o = last_place.top().second;
-				last_place.pop();
-			}
-		}
-		else
-		{
-			last_place.push(std::pair<key_t, typename std::list<edge_t>::iterator>(vertex, o));
-			vertex = o->head;
-			o = incidences.at(vertex).outedges.begin();
-			function(vertex, incidences.at(vertex).data);
-			visited.at(vertex) = true;
-			--count;
-		}
-	}
+	uint32_t tail = parents[index->id(vertex)];
+	if (tail == no_vertex)
+		throw error_t(problem_t::no_path);
+	return index->keys[tail];
 }
 
-/** Solves the problem of finding the shortest paths from vertex 'source' to all the vertices in the graph
-* by means of the Dijkstra's algorithm.
-* @return an object containing the solution to the problem
-* @throw error_t(problem_t::out_of_range) - if 'source' is absent in the graph
+/** Returns the vertices of the path from the initial vertex to 'terminal' along the breadth first tree,
+* which has the fewest edges of all such paths.
+* @return the keys of the vertices, beginning with the initial one; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'terminal' was absent in the graph
 */
-template<class key_t, class data_t, class weight_t>
-typename my_graph<key_t, data_t, weight_t>::OneToAll_t my_graph<key_t, data_t, weight_t>::Dijkstra(key_t source)
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<key_t> my_graph<key_t, data_t, weight_t, policy_t>::BreadthFirst_t::path_vertices(key_t terminal)
 {
-	if (incidences.find(source) == incidences.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	OneToAll_t results(source);
-	std::unordered_map<key_t, bool> visited;
-	std::vector<key_t> heap;
-	key_t closest = undefined;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-	{
-		heap.push_back(i->first);
-		if (heap.back() == source)
-			std::swap(heap.front(), heap.back());
-		results.distance[i->first] = infinity;
-		results.predecessor[i->first] = undefined;
-		visited[i->first] = false;
-	}
-	results.distance[source] = 0.0;
-	for (size_t count = graph_order; count > 0; --count)
-	{
-		closest = heap[0];
-		visited[closest] = true;
-		std::pop_heap(heap.begin(), heap.begin() + count,
-			[&results, &visited](key_t left, key_t right)
-			{ return visited[left] or (results.distance[left] > results.distance[right]); });
-		for (auto o = incidences[closest].outedges.begin(); o != incidences[closest].outedges.end(); ++o)
-		{
-			if (o->weight < 0.0)
-				throw error_t(problem_t::negative_weight);
-			if (results.distance[closest] + o->weight < results.distance.at(o->head))
-			{
-				results.distance[o->head] = results.distance[closest] + o->weight;
-				results.predecessor[o->head] = closest;
-			}
-		}
-	}
-	return results;
+	std::vector<key_t> path;
+	uint32_t vertex = index->id(terminal);
+	if (parents[vertex] == no_vertex)
+		return path;
+	for (; vertex != initial; vertex = parents[vertex])
+		path.push_back(index->keys[vertex]);
+	path.push_back(index->keys[initial]);
+	std::reverse(path.begin(), path.end());
+	return path;
 }
 
-/** Checks whether the graph is empty.
-* @returns 'true' if the graph is empty, 'false' otherwise
-*/
-template<class key_t, class data_t, class weight_t>
-bool my_graph<key_t, data_t, weight_t>::empty()
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::BreadthFirst_t::clear()
 {
-	return incidences.empty();
+	index.reset();
+	initial = no_vertex;
+	levels.clear();
+	parents.clear();
 }
 
-template<class key_t, class data_t, class weight_t>
-typename my_graph<key_t, data_t, weight_t>::OneToAll_t my_graph<key_t, data_t, weight_t>::Bellman_Ford(key_t source)
+/// Returns the cost of the path, or infinity if the target is unreachable.
+template<class key_t, class data_t, class weight_t, class policy_t>
+weight_t my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t::path_cost()
 {
-	if (incidences.find(source) == incidences.end())
-		throw error_t(problem_t::out_of_range);
-	OneToAll_t results(source);
-	std::unordered_map<key_t, bool> visited;
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-	{
-		results.distance[i->first] = infinity;
-		results.predecessor[i->first] = undefined;
-		visited[i->first] = false;
-	}
-	results.distance[source] = 0;
-	bool finish = false;
-	for (size_t count = 1; count < incidences.size(); ++count)
-	{
-		finish = true;
-		for (auto i = incidences.begin(); i != incidences.end(); ++i)
-		{
-			for (auto o = i->second.outedges.begin(); o != i->second.outedges.end(); ++o)
-			{
-				if (results.distance[i->first] + o->weight < results.distance[o->head])
-				{
-					finish = false;
-					results.distance[o->head] = results.distance[i->first] + o->weight;
-					results.predecessor[o->head] = i->first;
-				}
-			}
-		}
-		if (finish)
-			break;
-	}
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-	{
-		for (auto o = incidences[i->first].outedges.begin(); o != incidences[i->first].outedges.end(); ++o)
-		{
-			if (results.distance[i->first] + o->weight < results.distance[o->head])
-				throw error_t(problem_t::negative_cycle);
-		}
-	}
-	return results;
+	return cost;
 }
 
-template<class key_t, class data_t, class weight_t>
-typename my_graph<key_t, data_t, weight_t>::AllToAll_t my_graph<key_t, data_t, weight_t>::Floyd_Warshall()
+/// Returns the keys of the vertices of the path, beginning with the source; empty if there is no path.
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<key_t> my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t::path_vertices()
 {
-	AllToAll_t results = AllToAll_t();
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-	{
-		for (auto j = incidences.begin(); j != incidences.end(); ++j)
-		{
-			if (i->first == j->first)
-			{
-				results.distance[i->first][j->first] = 0;
-				results.successor[i->first][j->first] = j->first;
-			}
-			else
-			{
-				results.distance[i->first][j->first] = infinity;
-				results.successor[i->first][j->first] = undefined;
-				for (auto o = incidences[i->first].outedges.begin(); o != incidences[i->first].end(); ++o)
-				{
-					if (o->head == j->first and o->weight < results.distance[i->first][j->first])
-					{
-						results.distance[i->first][j->first] = o->weight;
-						results.successor[i->first][j->first] = j->first;
-					}
-				}
-			}
-		}
-	}
-	for (auto k = incidences.begin(); k != incidences.end(); ++k)
-	{
-		for (auto i = incidences.begin(); i != incidences.end(); ++i)
-		{
-			if (results.distance[i->first][k->first] != infinity)
-			{
-				for (auto j = incidences.begin(); j != incidences.end(); ++j)
-				{
-					if (results.distance[i->first][k->first] + results.distance[k->first][j->first]
-						< results.distance[i->first][j->first])
-					{
-						results.distance[i->first][j->first]
-							= results.distance[i->first][k->first] + results.distance[k->first][j->first];
-						results.successor[i->first][j->first] = results.successor[i->first][k->first];
-					}
-				}
-			}
-		}
-	}
-	for (auto i = incidences.begin(); i != incidences.end(); ++i)
-		if (results.distance[i->first][i->first] < 0)
-			throw error_t(problem_t::negative_cycle);
-	return results;
+	std::vector<key_t> path;
+	path.reserve(vertices.size());
+	for (auto v = vertices.begin(); v != vertices.end(); ++v)
+		path.push_back(index->keys[*v]);
+	return path;
 }
 
-template<class key_t, class data_t, class weight_t>
-weight_t my_graph<key_t, data_t, weight_t>::OneToAll_t::path_cost(key_t terminal)
+/// Returns the ordinal numbers of the edges of the path, in its order; empty if there is no path.
+template<class key_t, class data_t, class weight_t, class policy_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t::path_edges()
+{
+	return edges;
+}
+
+/** Returns the cost of the shortest path from 'initial' to 'terminal'.
+* @return the cost of the path, or infinity if 'terminal' is unreachable from 'initial'
+* @throw error_t(problem_t::out_of_range) - if 'initial' or 'terminal' was absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+cost_t my_graph<key_t, data_t, weight_t, policy_t>::AllToAll_table_t<cost_t, hop_t>::path_cost(key_t initial, key_t terminal)
 {
-	if (distance.find(terminal) == distance.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
-	return distance[terminal];
+	return distance[index->id(initial) * index->keys.size() + index->id(terminal)];
 }
 
-template<class key_t, class data_t, class weight_t>
-std::vector<key_t> my_graph<key_t, data_t, weight_t>::OneToAll_t::path_vertices(key_t terminal)
+/** Returns the vertices of the shortest path from 'initial' to 'terminal'.
+* @return the keys of the vertices, beginning with 'initial'; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'initial' or 'terminal' was absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+std::vector<key_t> my_graph<key_t, data_t, weight_t, policy_t>::AllToAll_table_t<cost_t, hop_t>::path_vertices(
+	key_t initial, key_t terminal)
 {
-	if (predecessor.find(terminal) == predecessor.end())
+	if (not index)
 		throw error_t(problem_t::out_of_range);
+	size_t n = index->keys.size();
+	size_t vertex = index->id(initial), target = index->id(terminal);
 	std::vector<key_t> path;
-	if (predecessor[terminal] == undefined)
+	if (successor[vertex * n + target] == no_hop)
 		return path;
-	for (key_t vertex = terminal; vertex != initial; vertex = predecessor[vertex])
-		path.push_back(vertex);
-	path.push_back(initial);
-	for (size_t i = 0; i < path.size() / 2; ++i)
-		std::swap(path[i], path[path.size() - i - 1]);
+	for (; vertex != target; vertex = successor[vertex * n + target])
+		path.push_back(index->keys[vertex]);
+	path.push_back(terminal);
 	return path;
 }
 
-template<class key_t, class data_t, class weight_t>
-std::vector<size_t> my_graph<key_t, data_t, weight_t>::OneToAll_t::path_edges(key_t terminal)
+/** Returns the edges of the shortest path from 'initial' to 'terminal'; between two consecutive
+* vertices the path takes the lightest of the parallel edges.
+* @return the ordinal numbers of the edges, in the order of the path; empty if there is no such path
+* @throw error_t(problem_t::out_of_range) - if 'initial' or 'terminal' was absent in the graph
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+std::vector<size_t> my_graph<key_t, data_t, weight_t, policy_t>::AllToAll_table_t<cost_t, hop_t>::path_edges(
+	key_t initial, key_t terminal)
 {
-	return std::vector<key_t>();
+	if (not index)
+		throw error_t(problem_t::out_of_range);
+	size_t n = index->keys.size();
+	size_t vertex = index->id(initial), target = index->id(terminal);
+	std::vector<size_t> path;
+	if (successor[vertex * n + target] == no_hop)
+		return path;
+	while (vertex != target)
+	{
+		uint32_t next = successor[vertex * n + target];
+		auto first = heads.begin() + offsets[vertex], last = heads.begin() + offsets[vertex + 1];
+		path.push_back(ordinals[std::lower_bound(first, last, next) - heads.begin()]);
+		vertex = next;
+	}
+	return path;
 }
 
-template<class key_t, class data_t, class weight_t>
-void my_graph<key_t, data_t, weight_t>::OneToAll_t::clear()
+template<class key_t, class data_t, class weight_t, class policy_t>
+template<class cost_t, class hop_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::AllToAll_table_t<cost_t, hop_t>::clear()
 {
-	initial = undefined;
+	index.reset();
 	distance.clear();
-	predecessor.clear();
+	successor.clear();
+	offsets.assign(1, 0);
+	heads.clear();
+	ordinals.clear();
 }
 
-template<class key_t, class data_t, class weight_t>
-weight_t my_graph<key_t, data_t, weight_t>::AllToAll_t::path_cost(key_t initial, key_t terminal)
+/// Returns the number of the shortcuts in the hierarchy.
+template<class key_t, class data_t, class weight_t, class policy_t>
+size_t my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t::shortcuts()
 {
-	if (distance.find(initial) == distance.end())
-		throw error_t(problem_t::out_of_range);
-	if (distance[initial].find(terminal) == distance[initial].end())
-		throw error_t(problem_t::out_of_range);
-	return distance[initial][terminal];
+	size_t count = 0;
+	for (auto a = arcs.begin(); a != arcs.end(); ++a)
+		count += a->second != no_arc;
+	return count;
 }
 
-template<class key_t, class data_t, class weight_t>
-std::vector<key_t> my_graph<key_t, data_t, weight_t>::AllToAll_t::path_vertices(key_t initial, key_t terminal)
+/// Appends the indices of the edge arcs that arc 'arc' stands for to 'edges', in the order of the path.
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t::unpack(size_t arc, std::vector<size_t>& edges)
 {
-	if (successor.find(initial) == successor.end())
-		throw error_t(problem_t::out_of_range);
-	if (successor[initial].find(terminal) == successor[initial].end())
-		throw error_t(problem_t::out_of_range);
-	std::vector<key_t> path;
-	if (successor[initial][terminal] == undefined)
-		return path;
-	for (key_t vertex = initial; vertex != terminal; vertex = successor[vertex][terminal])
-		path.push_back(vertex);
-	path.push_back(terminal);
-	return path;
+	std::vector<size_t> pending(1, arc);
+	while (not pending.empty())
+	{
+		size_t next = pending.back();
+		pending.pop_back();
+		if (arcs[next].second == no_arc)
+			edges.push_back(next);
+		else
+		{
+			pending.push_back(arcs[next].second);
+			pending.push_back(arcs[next].first);
+		}
+	}
 }
 
-template<class key_t, class data_t, class weight_t>
-std::vector<size_t> my_graph<key_t, data_t, weight_t>::AllToAll_t::path_edges(key_t initial, key_t terminal)
+/** Finds the shortest path from 'source' to 'target' by two searches over the arcs leading to vertices
+* of higher rank, forward from 'source' and backward from 'target'. A search stops once its closest
+* vertex is no nearer than the best meeting found. The searches keep labels only for the vertices they
+* reach, so the cost of a query does not depend on the size of the graph.
+* @return an object containing the path in terms of the original vertices and edges
+* @throw error_t(problem_t::out_of_range) - if 'source' or 'target' is absent in the hierarchy
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::OneToOne_t my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t::shortest_path(
+	key_t source, key_t target)
+{
+	uint32_t initial = index->id(source), terminal = index->id(target);
+	using entry_t = std::pair<weight_t, uint32_t>;
+	using queue_t = std::priority_queue<entry_t, std::vector<entry_t>, std::greater<entry_t>>;
+	// The cost of each reached vertex from the end of the search, and the arc that reached it.
+	std::unordered_map<uint32_t, std::pair<weight_t, size_t>> labels[2];
+	queue_t queues[2];
+	labels[0].emplace(initial, std::make_pair(weight_t(), no_arc));
+	labels[1].emplace(terminal, std::make_pair(weight_t(), no_arc));
+	queues[0].emplace(weight_t(), initial);
+	queues[1].emplace(weight_t(), terminal);
+	weight_t best = infinity;
+	uint32_t meeting = no_vertex;
+	for (size_t side = 0; not queues[0].empty() or not queues[1].empty(); side = 1 - side)
+	{
+		if (queues[side].empty())
+			continue;
+		entry_t closest = queues[side].top();
+		queues[side].pop();
+		if (not (closest.first < best))
+		{
+			queues[side] = queue_t();
+			continue;
+		}
+		if (labels[side][closest.second].first < closest.first)
+			continue;
+		auto other = labels[1 - side].find(closest.second);
+		if (other != labels[1 - side].end() and closest.first + other->second.first < best)
+		{
+			best = closest.first + other->second.first;
+			meeting = closest.second;
+		}
+		const std::vector<size_t>& bounds = side == 0 ? up_offsets : down_offsets;
+		const std::vector<uint32_t>& list = side == 0 ? up : down;
+		for (size_t r = bounds[closest.second]; r < bounds[closest.second + 1]; ++r)
+		{
+			const arc_t& arc = arcs[list[r]];
+			uint32_t next = side == 0 ? arc.head : arc.tail;
+			weight_t length = closest.first + arc.weight;
+			auto label = labels[side].find(next);
+			if (label == labels[side].end() or length < label->second.first)
+			{
+				labels[side][next] = std::make_pair(length, static_cast<size_t>(list[r]));
+				queues[side].emplace(length, next);
+			}
+		}
+	}
+	OneToOne_t results;
+	results.index = index;
+	results.cost = best;
+	if (meeting == no_vertex)
+		return results;
+	std::vector<size_t> path, edges;
+	for (size_t arc = labels[0][meeting].second; arc != no_arc; arc = labels[0][arcs[arc].tail].second)
+		path.push_back(arc);
+	std::reverse(path.begin(), path.end());
+	for (size_t arc = labels[1][meeting].second; arc != no_arc; arc = labels[1][arcs[arc].head].second)
+		path.push_back(arc);
+	for (auto a = path.begin(); a != path.end(); ++a)
+		unpack(*a, edges);
+	results.vertices.push_back(initial);
+	for (auto e = edges.begin(); e != edges.end(); ++e)
+	{
+		results.vertices.push_back(arcs[*e].head);
+		results.edges.push_back(arcs[*e].first);
+	}
+	return results;
+}
+
+/** Writes the hierarchy to a binary file, to be read back by load_binary() together with the graph it
+* was built from. The keys are not stored; they are taken from the graph.
+* @throw error_t(problem_t::io_failure) - if the file cannot be written
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+void my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t::save_binary(const std::string& path)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	if (not file)
+		throw error_t(problem_t::io_failure);
+	header_t header = header_t();
+	std::memcpy(header.signature, "DWHIERA", 8);
+	header.version = format_version;
+	header.endianness = 0x01020304;
+	header.index_width = sizeof(size_t);
+	header.weight_width = sizeof(weight_t);
+	header.order = rank.size();
+	header.arcs = arcs.size();
+	header.up = up.size();
+	header.down = down.size();
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(rank.data()), rank.size() * sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(arcs.data()), arcs.size() * sizeof(arc_t));
+	file.write(reinterpret_cast<const char*>(up_offsets.data()), up_offsets.size() * sizeof(size_t));
+	file.write(reinterpret_cast<const char*>(up.data()), up.size() * sizeof(uint32_t));
+	file.write(reinterpret_cast<const char*>(down_offsets.data()), down_offsets.size() * sizeof(size_t));
+	file.write(reinterpret_cast<const char*>(down.data()), down.size() * sizeof(uint32_t));
+	if (not file)
+		throw error_t(problem_t::io_failure);
+}
+
+/** Reads a hierarchy written by save_binary() and attaches it to 'graph', the snapshot of the graph
+* it was built from.
+* @return the hierarchy
+* @throw error_t(problem_t::io_failure) - if the file cannot be opened or read
+* @throw error_t(problem_t::invalid_value) - if the file was not written by save_binary() for this
+* instantiation of the template on a platform of the same layout, or does not match 'graph'
+*/
+template<class key_t, class data_t, class weight_t, class policy_t>
+typename my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t my_graph<key_t, data_t, weight_t, policy_t>::hierarchy_t::load_binary(
+	const std::string& path, snapshot_t graph)
 {
-	return std::vector<size_t>();
+	file_mapping_t file(path);
+	const char* cursor = file.begin();
+	const char* end = cursor + file.size();
+	header_t header;
+	read_binary(cursor, end, header);
+	if (std::memcmp(header.signature, "DWHIERA", 8) != 0 or header.version != format_version
+		or header.endianness != 0x01020304 or header.index_width != sizeof(size_t)
+		or header.weight_width != sizeof(weight_t) or header.order != graph.order())
+		throw error_t(problem_t::invalid_value);
+	auto section = [&cursor, end](auto& items, uint64_t count)
+	{
+		using item_t = typename std::decay_t<decltype(items)>::value_type;
+		if (count > static_cast<uint64_t>(end - cursor) / sizeof(item_t))
+			throw error_t(problem_t::invalid_value);
+		items.resize(static_cast<size_t>(count));
+		// An empty vector may have no storage, which memcpy() must not be given.
+		if (count == 0)
+			return;
+		std::memcpy(items.data(), cursor, items.size() * sizeof(item_t));
+		cursor += items.size() * sizeof(item_t);
+	};
+	hierarchy_t results;
+	results.index = graph.index;
+	section(results.rank, header.order);
+	section(results.arcs, header.arcs);
+	section(results.up_offsets, header.order + 1);
+	section(results.up, header.up);
+	section(results.down_offsets, header.order + 1);
+	section(results.down, header.down);
+	bool valid = results.up_offsets.back() == header.up and results.down_offsets.back() == header.down;
+	for (size_t v = 0; valid and v < header.order; ++v)
+	{
+		valid = results.up_offsets[v] <= results.up_offsets[v + 1] and results.down_offsets[v] <= results.down_offsets[v + 1];
+	}
+	// A shortcut always refers to arcs created before it, which keeps the unpacking finite.
+	for (size_t a = 0; valid and a < results.arcs.size(); ++a)
+	{
+		const arc_t& arc = results.arcs[a];
+		valid = arc.tail < header.order and arc.head < header.order
+			and (arc.second == no_arc or (arc.first < a and arc.second < a));
+	}
+	for (auto a = results.up.begin(); valid and a != results.up.end(); ++a)
+		valid = *a < header.arcs;
+	for (auto a = results.down.begin(); valid and a != results.down.end(); ++a)
+		valid = *a < header.arcs;
+	if (not valid)
+		throw error_t(problem_t::invalid_value);
+	return results;
 }
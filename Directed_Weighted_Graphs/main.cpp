@@ -171,11 +171,17 @@ int main()
 
 	header("BFS, print the number of inhabitants");
 	towns.breadth_first_search(
-		[](std::string k, unsigned int d)
+		[](const std::string& k, unsigned int& d)
 		{
 			std::cout << k << " has " << d << " inhabitants." << std::endl;
 		},
 		"Piri");
+	auto tree = towns.breadth_first_tree("Piri");
+	std::cout << "Dimi is " << tree.level("Dimi") << " edges away from Piri." << std::endl;
+	std::cout << "The first three towns in the breadth first order:";
+	for (const std::string& k : towns.bfs("Piri") | std::views::take(3))
+		std::cout << " " << k;
+	std::cout << std::endl;
 
 	header("DFS, print the number of inhabitants");
 	towns.depth_first_search(
@@ -217,6 +223,17 @@ int main()
 		}
 	std::cout << std::endl;
 
+	auto tracker = towns.track("Fiki");
+	towns.insert_edge("Fiki", "Dimi", 1.0);
+	std::cout << "With an edge from Fiki to Dimi, the tracked cost is: " << tracker->path_cost("Dimi") << std::endl;
+	towns.erase_edges("Fiki", "Dimi");
+	std::cout << "Without it, the tracked cost is again: " << tracker->path_cost("Dimi") << std::endl;
+
+	my_graph<std::string, unsigned int>::cache_t cache(towns, 1 << 20);
+	cache.Dijkstra("Fiki");
+	std::cout << "The cached cost from Fiki to Dimi: " << cache.Dijkstra("Fiki")->path_cost("Dimi")
+		<< " (" << cache.statistics().hits << " hit, " << cache.statistics().misses << " miss)" << std::endl;
+
 	header("Bellman-Ford");
 	auto Bellman_Ford = towns.Bellman_Ford("Fiki");
 	std::cout << "The shortest path from Fiki to Dimi has cost: " << Bellman_Ford.path_cost("Dimi") << std::endl;
@@ -242,6 +259,42 @@ int main()
 	}
 	std::cout << std::endl;
 
+	header("freeze, Dijkstra on the snapshot");
+	auto snapshot = towns.freeze();
+	std::cout << "order = " << snapshot.order() << ", size = " << snapshot.size() << std::endl;
+	Dijkstra = snapshot.Dijkstra("Fiki");
+	std::cout << "The shortest path from Fiki to Dimi has cost: " << Dijkstra.path_cost("Dimi") << std::endl;
+	auto nearest = snapshot.nearest_source_paths({ "Fiki", "Sele" });
+	std::cout << "Of Fiki and Sele, Dimi is nearest to " << nearest.nearest_source("Dimi")
+		<< " (cost " << nearest.path_cost("Dimi") << ")" << std::endl;
+	auto route = snapshot.bidirectional_path("Fiki", "Dimi");
+	std::cout << "Bidirectional search gives the path: ";
+	auto stops = route.path_vertices();
+	for (auto p = stops.begin(); p != stops.end(); ++p)
+		std::cout << *p << " ";
+	std::cout << "(cost " << route.path_cost() << ")" << std::endl;
+	auto hierarchy = snapshot.contract();
+	route = hierarchy.shortest_path("Fiki", "Dimi");
+	std::cout << "The contraction hierarchy has " << hierarchy.shortcuts() << " shortcuts and gives the path: ";
+	stops = route.path_vertices();
+	for (auto p = stops.begin(); p != stops.end(); ++p)
+		std::cout << *p << " ";
+	std::cout << "(cost " << route.path_cost() << ")" << std::endl;
+
+	header("integral weights");
+	my_graph<std::string, unsigned int, int> lines;
+	for (auto stop : { "Fiki", "Dimi", "Rava", "Sele", "Waya", "Kora" })
+		lines.insert_vertex(stop);
+	lines.insert_edge("Fiki", "Dimi", 30);
+	lines.insert_edge("Dimi", "Rava", 10);
+	lines.insert_edge("Dimi", "Sele", 15);
+	lines.insert_edge("Dimi", "Rava", 3);
+	lines.insert_edge("Dimi", "Waya", 4);
+	lines.insert_edge("Rava", "Kora", 1);
+	lines.insert_edge("Waya", "Kora", 5);
+	std::cout << "The shortest path from Fiki to Kora has cost: " << lines.shortest_path("Fiki", "Kora").path_cost()
+		<< " (Dijkstra: " << lines.Dijkstra("Fiki").path_cost("Kora") << ")" << std::endl;
+
 	header("negative edge");
 	std::cout << "Dijktra" << std::endl;
 	towns.edge_weight(1) = -1.0;